@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/AI/BTService_TargetLock.h"
+#include "TargetLock/Data/TargetLockConfig.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "TargetLockUtilities.h"
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+
+UBTService_TargetLock::UBTService_TargetLock(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	NodeName = "Target Lock";
+	bNotifyBecomeRelevant = true;
+	bNotifyCeaseRelevant = true;
+	Interval = 0.5f;
+	RandomDeviation = 0.1f;
+
+	TargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UBTService_TargetLock, TargetKey), AActor::StaticClass());
+}
+
+void UBTService_TargetLock::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BlackboardAsset = GetBlackboardAsset())
+	{
+		TargetKey.ResolveSelectedKey(*BlackboardAsset);
+	}
+}
+
+uint16 UBTService_TargetLock::GetInstanceMemorySize() const
+{
+	return sizeof(FBTTargetLockServiceMemory);
+}
+
+FString UBTService_TargetLock::GetStaticDescription() const
+{
+	return FString::Printf(TEXT("%s\nTarget Lock: %s -> %s"), *Super::GetStaticDescription(),
+		*GetNameSafe(TargetLockConfig), *TargetKey.SelectedKeyName.ToString());
+}
+
+void UBTService_TargetLock::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	Super::OnBecomeRelevant(OwnerComp, NodeMemory);
+
+	FBTTargetLockServiceMemory* Memory = new(NodeMemory) FBTTargetLockServiceMemory();
+	UpdateTarget(OwnerComp, *Memory, 0);
+}
+
+void UBTService_TargetLock::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	FBTTargetLockServiceMemory* Memory = reinterpret_cast<FBTTargetLockServiceMemory*>(NodeMemory);
+	Memory->Target.Reset();
+	ApplyTarget(OwnerComp, nullptr);
+
+	Super::OnCeaseRelevant(OwnerComp, NodeMemory);
+}
+
+void UBTService_TargetLock::TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	Super::TickNode(OwnerComp, NodeMemory, DeltaSeconds);
+
+	UpdateTarget(OwnerComp, *reinterpret_cast<FBTTargetLockServiceMemory*>(NodeMemory), DeltaSeconds);
+}
+
+void UBTService_TargetLock::UpdateTarget(UBehaviorTreeComponent& OwnerComp, FBTTargetLockServiceMemory& Memory, float DeltaSeconds) const
+{
+	const AAIController* AIController = OwnerComp.GetAIOwner();
+	APawn* Pawn = AIController ? AIController->GetPawn() : nullptr;
+	if (!Pawn || !TargetLockConfig) return;
+
+	const FStruct_TargetLockData& Config = TargetLockConfig->Data;
+	const FTargetLockViewPoint ViewPoint = UTargetLockUtilities::GetViewPoint(Pawn);
+
+	AActor* Target = Memory.Target.Get();
+	if (Target)
+	{
+		//Like the task, the lock only breaks once the target failed for the grace time, so a single blocked trace
+		//doesn't make the focus flicker. The target got lost somewhere since the last tick, the first failed tick counts as 0.
+		const bool bStillLockable = UTargetLockUtilities::IsTargetStillLockable(Pawn, Config, Pawn, ViewPoint, Target);
+		const float FailedTime = Memory.bLosingTarget ? DeltaSeconds : 0;
+		Memory.bLosingTarget = !bStillLockable;
+		if (!UTargetLockUtilities::UpdateLockBreakTimer(Config, bStillLockable, FailedTime, Memory.LockBreakTimer)) return;
+	}
+
+	//Searches go through the batched acquisition of the subsystem, so a whole wave of AI acquiring in
+	//the same frame shares its overlaps. The result gets picked up on the next tick of this service.
+	UTargetLockSubsystem* Subsystem = Pawn->GetWorld()->GetSubsystem<UTargetLockSubsystem>();
+	if (!Subsystem)
+	{
+		Target = UTargetLockUtilities::FindBestTargetFromViewPoint(Pawn, Config, Pawn, ViewPoint);
+	}
+	else if (!Subsystem->ConsumeAcquisitionResult(Pawn, Target) || !UTargetLockUtilities::IsTargetStillLockable(Pawn, Config, Pawn, ViewPoint, Target))
+	{
+		Target = nullptr;
+
+		FTargetLockLocker Locker;
+		Locker.Owner = Pawn;
+		Locker.ViewPoint = ViewPoint;
+		Locker.Config = TargetLockConfig;
+		Subsystem->RequestAcquisition(Locker);
+	}
+
+	if (Target != Memory.Target.Get())
+	{
+		Memory.Target = Target;
+		Memory.LockBreakTimer = 0;
+		Memory.bLosingTarget = false;
+		ApplyTarget(OwnerComp, Target);
+	}
+}
+
+void UBTService_TargetLock::ApplyTarget(UBehaviorTreeComponent& OwnerComp, AActor* Target) const
+{
+	if (UBlackboardComponent* Blackboard = OwnerComp.GetBlackboardComponent())
+	{
+		if (TargetKey.SelectedKeyType == UBlackboardKeyType_Object::StaticClass())
+		{
+			Blackboard->SetValueAsObject(TargetKey.SelectedKeyName, Target);
+		}
+	}
+
+	if (!bSetFocus) return;
+
+	if (AAIController* AIController = OwnerComp.GetAIOwner())
+	{
+		if (Target)
+		{
+			AIController->SetFocus(Target, EAIFocusPriority::Gameplay);
+		}
+		else
+		{
+			AIController->ClearFocus(EAIFocusPriority::Gameplay);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTService.h"
+#include "BTService_TargetLock.generated.h"
+
+class UTargetLockConfig;
+
+struct FBTTargetLockServiceMemory
+{
+	TWeakObjectPtr<AActor> Target;
+
+	//How long the target has not been lockable, see UTargetLockUtilities::UpdateLockBreakTimer
+	float LockBreakTimer = 0;
+
+	//The target wasn't lockable on the last tick
+	bool bLosingTarget = false;
+};
+
+/**
+ * Camera-less target lock for AI.
+ * Finds the best lockable target from the pawns view point, writes it into the blackboard and lets the
+ * AI controller focus it. The target is kept until it broke the lock rules of the config for its LockBreakGraceTime,
+ * then a new one is searched.
+ */
+UCLASS()
+class TARGETLOCK_API UBTService_TargetLock : public UBTService
+{
+	GENERATED_BODY()
+
+public:
+	UBTService_TargetLock(const FObjectInitializer& ObjectInitializer);
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual uint16 GetInstanceMemorySize() const override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void TickNode(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+	//Keeps the current target until its lock breaks, searches a new one otherwise
+	void UpdateTarget(UBehaviorTreeComponent& OwnerComp, FBTTargetLockServiceMemory& Memory, float DeltaSeconds) const;
+
+	void ApplyTarget(UBehaviorTreeComponent& OwnerComp, AActor* Target) const;
+
+	UPROPERTY(EditAnywhere, Category = "Target Lock")
+	TObjectPtr<UTargetLockConfig> TargetLockConfig;
+
+	//Blackboard key the locked target gets written to
+	UPROPERTY(EditAnywhere, Category = "Target Lock")
+	FBlackboardKeySelector TargetKey;
+
+	//Let the AI controller focus the locked target
+	UPROPERTY(EditAnywhere, Category = "Target Lock")
+	bool bSetFocus = true;
+};
@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/AsyncActions/AsyncAction_TargetLock.h"
+#include "TargetLockUtilities.h"
+#include "TargetLock/Data/TargetLockConfig.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "TargetLock/Debug/TargetLockDebugStats.h"
+#include "Camera/CameraComponent.h"
+#include "AIController.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+
+UAsyncAction_TargetLock* UAsyncAction_TargetLock::AsyncTargetLock(UObject* WorldContext, UCameraComponent* CameraComponent,
+	const FStruct_TargetLockData& TargetLockData, UTargetLockConfig* Config, AActor* LockTarget, float UpdateFrequency)
+{
+	UAsyncAction_TargetLock* Action = NewObject<UAsyncAction_TargetLock>();
+	Action->World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull);
+	Action->CameraComponent = CameraComponent;
+	Action->LockTarget = LockTarget;
+	Action->ConfigAsset = Config;
+	Action->UpdateFrequency = FMath::Max(UpdateFrequency, 0.f);
+
+	if (!Config)
+	{
+		Action->Configuration = TargetLockData;
+		if (Action->Configuration.UseWeightedScoring)
+		{
+			//Config assets bake their curves on load, the copy of inline data has to do it here
+			Action->Configuration.Scoring.Bake();
+		}
+		UTargetLockSubsystem::CacheTargetTagQueryId(Action->Configuration);
+	}
+
+	Action->RegisterWithGameInstance(WorldContext);
+	return Action;
+}
+
+const FStruct_TargetLockData& UAsyncAction_TargetLock::GetConfiguration() const
+{
+	return ConfigAsset ? ConfigAsset->Data : Configuration;
+}
+
+void UAsyncAction_TargetLock::Activate()
+{
+	AActor* Owner = CameraComponent ? CameraComponent->GetOwner() : nullptr;
+	if (Owner && !LockTarget)
+	{
+		LockTarget = UTargetLockUtilities::FindBestTarget(Owner, GetConfiguration(), Owner, CameraComponent);
+	}
+
+	if (!Owner || !LockTarget)
+	{
+		EndLock();
+		return;
+	}
+
+	bActive = true;
+	OnStarted.Broadcast(LockTarget);
+}
+
+void UAsyncAction_TargetLock::Cancel()
+{
+	EndLock();
+}
+
+void UAsyncAction_TargetLock::SetLockTarget(AActor* NewTarget)
+{
+	if (!bActive) return;
+
+	AActor* Owner = CameraComponent ? CameraComponent->GetOwner() : nullptr;
+	if (!NewTarget && Owner)
+	{
+		NewTarget = UTargetLockUtilities::FindBestTarget(Owner, GetConfiguration(), Owner, CameraComponent);
+	}
+
+	if (!NewTarget)
+	{
+		EndLock();
+		return;
+	}
+
+	if (NewTarget == LockTarget) return;
+
+	LockTarget = NewTarget;
+	LockBreakTimer = 0;
+	OnTargetChanged.Broadcast(LockTarget);
+}
+
+void UAsyncAction_TargetLock::Tick(float DeltaTime)
+{
+	//we clamp the value to be 0.1 (10 fps) in order to keep uncontrollable spins from happening
+	DeltaTime = FMath::Min(DeltaTime, 0.1f);
+
+	const bool bWasRotating = bRotating;
+	const bool bWasBreaking = bBreaking;
+
+	if (!UpdateLock(DeltaTime))
+	{
+		EndLock();
+		return;
+	}
+
+	//Only run the graph behind OnUpdated as often as asked for, instead of every frame
+	bool bFireUpdate = false;
+	if (UpdateFrequency > 0)
+	{
+		TimeSinceUpdate += DeltaTime;
+		if (TimeSinceUpdate >= 1.f / UpdateFrequency)
+		{
+			TimeSinceUpdate = 0;
+			bFireUpdate = true;
+		}
+	}
+	else
+	{
+		bFireUpdate = bWasRotating != bRotating || bWasBreaking != bBreaking;
+	}
+
+	if (bFireUpdate)
+	{
+		OnUpdated.Broadcast(LockTarget);
+	}
+}
+
+bool UAsyncAction_TargetLock::UpdateLock(float DeltaTime)
+{
+	AActor* Owner = CameraComponent ? CameraComponent->GetOwner() : nullptr;
+	if (!LockTarget || !Owner) return false;
+
+	FTargetLockScopedDebugTimer DebugTimer(Owner, ETargetLockDebugTimer::Solve);
+
+	const FStruct_TargetLockData& Config = GetConfiguration();
+	const FTargetLockViewPoint ViewPoint = UTargetLockUtilities::GetViewPoint(Owner, CameraComponent);
+
+	//Range, angle and Line of Sight only break the lock once they failed for the whole grace time
+	const bool bStillLockable = UTargetLockUtilities::IsTargetStillLockable(Owner, Config, Owner, ViewPoint, LockTarget);
+	if (UTargetLockUtilities::UpdateLockBreakTimer(Config, bStillLockable, DeltaTime, LockBreakTimer))
+	{
+		return false;
+	}
+	bBreaking = !bStillLockable;
+
+	AController* Controller = UTargetLockUtilities::GetLockController(Owner);
+	if (!Controller)
+	{
+		Controller = UGameplayStatics::GetPlayerController(Owner, 0);
+	}
+
+	//The focus of the AI controller does the rotating
+	if (!Controller || Controller->IsA<AAIController>()) return true;
+
+	float Angle = 0;
+	const FRotator RotationDelta = UTargetLockUtilities::ComputeLockRotationDelta(Config, ViewPoint.Location,
+		ViewPoint.Forward, LockTarget->GetActorLocation(), Controller->GetControlRotation(), DeltaTime, Angle);
+
+	bRotating = Angle >= Config.AngleToStartLerp;
+	if (bRotating)
+	{
+		Controller->SetControlRotation(Controller->GetControlRotation() + RotationDelta);
+	}
+	return true;
+}
+
+void UAsyncAction_TargetLock::EndLock()
+{
+	if (bEnded) return;
+
+	bEnded = true;
+	bActive = false;
+	AActor* LastTarget = LockTarget;
+	LockTarget = nullptr;
+	CameraComponent = nullptr;
+
+	OnCancelled.Broadcast(LastTarget);
+	SetReadyToDestroy();
+}
+
+UWorld* UAsyncAction_TargetLock::GetTickableGameObjectWorld() const
+{
+	return World.Get();
+}
+
+TStatId UAsyncAction_TargetLock::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAsyncAction_TargetLock, STATGROUP_Tickables);
+}
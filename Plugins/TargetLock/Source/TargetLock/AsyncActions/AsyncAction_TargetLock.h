@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "TargetLock/Data/TargetLockData.h"
+#include "AsyncAction_TargetLock.generated.h"
+
+class UCameraComponent;
+class UTargetLockConfig;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAsyncTargetLockEvent, AActor*, Target);
+
+/**
+ * Blueprint node that locks a camera onto a target until it gets cancelled or the lock breaks.
+ * Unlike the latent Target Lock node the graph behind it only runs when something happens:
+ * the lock started, the target changed, the lock got cancelled and, if wanted, a throttled update.
+ */
+UCLASS()
+class TARGETLOCK_API UAsyncAction_TargetLock : public UBlueprintAsyncActionBase, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Locks the camera onto a target.
+	 *
+	 * @param WorldContext					Variable holding the object calling this function. Hidden
+	 * @param CameraComponent				Required: The camera that should get locked onto a target. Its owner is the one locking on.
+	 * @param TargetLockData				The configuration of the lock. Ignored if a Config is given.
+	 * @param Config						Optional: Shared configuration, takes priority over TargetLockData.
+	 * @param LockTarget					Optional. If not given the best target gets searched with the configuration.
+	 * @param UpdateFrequency				How often per second OnUpdated fires. 0 only fires it when the lock starts or stops rotating the camera or the target starts or stops being out of reach.
+	 */
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContext", BlueprintInternalUseOnly = "true"), Category = "Async | TargetLock")
+	static UAsyncAction_TargetLock* AsyncTargetLock(UObject* WorldContext, UCameraComponent* CameraComponent, const FStruct_TargetLockData& TargetLockData,
+		UTargetLockConfig* Config = nullptr, AActor* LockTarget = nullptr, float UpdateFrequency = 0);
+
+	virtual void Activate() override;
+
+	//Stops the lock and fires OnCancelled
+	UFUNCTION(BlueprintCallable, Category = "Async | TargetLock")
+	void Cancel();
+
+	/**
+	 * Locks onto another target and fires OnTargetChanged.
+	 *
+	 * @param NewTarget The new target. If nullptr the best target gets searched, the lock gets cancelled if there is none.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Async | TargetLock")
+	void SetLockTarget(AActor* NewTarget);
+
+	UFUNCTION(BlueprintPure, Category = "Async | TargetLock")
+	AActor* GetLockTarget() const { return LockTarget; }
+
+	//FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override { return ETickableTickType::Conditional; }
+	virtual bool IsTickable() const override { return bActive; }
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnAsyncTargetLockEvent OnStarted;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnAsyncTargetLockEvent OnTargetChanged;
+
+	//Throttled, see UpdateFrequency
+	UPROPERTY(BlueprintAssignable)
+	FOnAsyncTargetLockEvent OnUpdated;
+
+	//Fires once when the lock ends, no matter if it was cancelled or broke on its own
+	UPROPERTY(BlueprintAssignable)
+	FOnAsyncTargetLockEvent OnCancelled;
+
+protected:
+	const FStruct_TargetLockData& GetConfiguration() const;
+
+	//Rotates the controller towards the target, returns false if the lock broke
+	bool UpdateLock(float DeltaTime);
+
+	void EndLock();
+
+	UPROPERTY()
+	TObjectPtr<UCameraComponent> CameraComponent;
+
+	UPROPERTY()
+	TObjectPtr<AActor> LockTarget;
+
+	UPROPERTY()
+	FStruct_TargetLockData Configuration;
+
+	UPROPERTY()
+	TObjectPtr<UTargetLockConfig> ConfigAsset;
+
+	TWeakObjectPtr<UWorld> World;
+
+	float UpdateFrequency = 0;
+	float TimeSinceUpdate = 0;
+
+	//How long the target has been out of range, angle or sight, see UTargetLockUtilities::UpdateLockBreakTimer
+	float LockBreakTimer = 0;
+
+	//Lock state of the last update, OnUpdated fires when it changes if there is no UpdateFrequency
+	bool bRotating = false;
+	bool bBreaking = false;
+
+	bool bActive = false;
+	bool bEnded = false;
+};
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/CameraModifiers/CameraModifier_TargetLock.h"
+#include "TargetLockUtilities.h"
+#include "TargetLock/Debug/TargetLockDebugStats.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+
+UCameraModifier_TargetLock::UCameraModifier_TargetLock()
+{
+	//Before camera shakes and other effects, so they get applied on top of the locked view
+	Priority = 0;
+}
+
+UCameraModifier_TargetLock* UCameraModifier_TargetLock::FindOrAdd(AController* Controller)
+{
+	const APlayerController* PlayerController = Cast<APlayerController>(Controller);
+	APlayerCameraManager* CameraManager = PlayerController ? PlayerController->PlayerCameraManager.Get() : nullptr;
+	if (!CameraManager) return nullptr;
+
+	if (UCameraModifier* Existing = CameraManager->FindCameraModifierByClass(StaticClass()))
+	{
+		return Cast<UCameraModifier_TargetLock>(Existing);
+	}
+	return Cast<UCameraModifier_TargetLock>(CameraManager->AddNewCameraModifier(StaticClass()));
+}
+
+void UCameraModifier_TargetLock::SetLockTarget(AActor* Target, const FStruct_TargetLockData& Config)
+{
+	LockTarget = Target;
+	Configuration = Config;
+}
+
+void UCameraModifier_TargetLock::ClearLockTarget(const AActor* Target)
+{
+	if (LockTarget.Get() == Target)
+	{
+		LockTarget.Reset();
+	}
+}
+
+bool UCameraModifier_TargetLock::ModifyCamera(float DeltaTime, FMinimalViewInfo& InOutPOV)
+{
+	Super::ModifyCamera(DeltaTime, InOutPOV);
+
+	const AActor* Target = LockTarget.Get();
+	APlayerController* Controller = CameraOwner ? CameraOwner->GetOwningPlayerController() : nullptr;
+	if (!Target || !Controller) return false;
+
+	FTargetLockScopedDebugTimer DebugTimer(Controller, ETargetLockDebugTimer::Solve);
+
+	//we clamp the value to be 0.1 (10 fps) in order to keep uncontrollable spins from happening
+	DeltaTime = FMath::Min(DeltaTime, 0.1f);
+
+	float Angle = 0;
+	const FRotator RotationDelta = UTargetLockUtilities::ComputeLockRotationDelta(Configuration, InOutPOV.Location,
+		InOutPOV.Rotation.Vector(), Target->GetActorLocation(), Controller->GetControlRotation(), DeltaTime, Angle);
+
+	if (Angle < Configuration.AngleToStartLerp) return false;
+
+	//The control rotation keeps the correction for the next frames, the view gets it right away
+	const FRotator BlendedDelta = RotationDelta * Alpha;
+	Controller->SetControlRotation(Controller->GetControlRotation() + BlendedDelta);
+	InOutPOV.Rotation += BlendedDelta;
+	return false;
+}
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Camera/CameraModifier.h"
+#include "TargetLock/Data/TargetLockData.h"
+#include "CameraModifier_TargetLock.generated.h"
+
+/**
+ * Rotates the player controller towards the lock target from inside APlayerCameraManager::UpdateCamera.
+ * The correction is computed from the view that is about to be rendered and applied to that view right away,
+ * so there is no frame of lag between the target moving and the camera following it.
+ * Added to the camera manager by locks with RotateInCameraUpdate, which then only do their checks in their own tick.
+ */
+UCLASS()
+class TARGETLOCK_API UCameraModifier_TargetLock : public UCameraModifier
+{
+	GENERATED_BODY()
+
+public:
+	UCameraModifier_TargetLock();
+
+	/**
+	 * Finds the target lock modifier of the camera manager of the given controller, adds one if there is none.
+	 *
+	 * @param Controller The controller whose camera should be rotated. Has to be a player controller with a camera manager.
+	 * @return The modifier or nullptr if the controller has no camera manager.
+	 */
+	static UCameraModifier_TargetLock* FindOrAdd(AController* Controller);
+
+	//Starts rotating towards the target. Only the rotation settings of the config are used.
+	void SetLockTarget(AActor* Target, const FStruct_TargetLockData& Config);
+
+	//Stops rotating, does nothing if the current target is a different one
+	void ClearLockTarget(const AActor* Target);
+
+	virtual bool ModifyCamera(float DeltaTime, FMinimalViewInfo& InOutPOV) override;
+
+protected:
+	TWeakObjectPtr<AActor> LockTarget;
+
+	//Copy of the config of the lock, only its rotation settings are used
+	UPROPERTY()
+	FStruct_TargetLockData Configuration;
+};
@@ -0,0 +1,175 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Components/TargetLockTrackerComponent.h"
+#include "TargetLockUtilities.h"
+#include "TargetLock/Data/TargetLockConfig.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "TargetLock/Debug/TargetLockDebugStats.h"
+#include "Camera/CameraComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "TimerManager.h"
+
+UTargetLockTrackerComponent::UTargetLockTrackerComponent()
+{
+	//Updates run on a timer, there is nothing to do every frame
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UTargetLockTrackerComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	//Pawns usually get possessed after BeginPlay, on clients only once the controller replicated
+	if (APawn* Pawn = Cast<APawn>(GetOwner()))
+	{
+		Pawn->ReceiveControllerChangedDelegate.AddDynamic(this, &UTargetLockTrackerComponent::OnControllerChanged);
+	}
+	UpdateTracking();
+}
+
+void UTargetLockTrackerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (APawn* Pawn = Cast<APawn>(GetOwner()))
+	{
+		Pawn->ReceiveControllerChangedDelegate.RemoveDynamic(this, &UTargetLockTrackerComponent::OnControllerChanged);
+	}
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(UpdateTimerHandle);
+	}
+	RemovePreview();
+	WouldLockTarget.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UTargetLockTrackerComponent::OnControllerChanged(APawn* Pawn, AController* OldController, AController* NewController)
+{
+	UpdateTracking();
+}
+
+void UTargetLockTrackerComponent::UpdateTracking()
+{
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (!ShouldTrack())
+	{
+		TimerManager.ClearTimer(UpdateTimerHandle);
+		SetWouldLockTarget(nullptr);
+		return;
+	}
+
+	if (TimerManager.IsTimerActive(UpdateTimerHandle)) return;
+
+	Camera = GetOwner()->FindComponentByClass<UCameraComponent>();
+
+	//A random first delay spreads the trackers of all players over the interval
+	const float Interval = 1.f / FMath::Max(UpdateRate, 0.1f);
+	TimerManager.SetTimer(UpdateTimerHandle, this, &UTargetLockTrackerComponent::UpdateWouldLockTarget,
+		Interval, true, FMath::FRandRange(0.f, Interval));
+}
+
+bool UTargetLockTrackerComponent::ShouldTrack() const
+{
+	const AActor* Owner = GetOwner();
+	if (!Owner || !Config) return false;
+
+	//Anything that isn't a pawn locks where it has authority
+	const APawn* Pawn = Cast<APawn>(Owner);
+	if (!Pawn) return Owner->HasAuthority();
+
+	//Unpossessed and AI pawns don't start locks through a tracker, simulated proxies never start any
+	const AController* Controller = Pawn->GetController();
+	if (!Controller || !Controller->IsPlayerController()) return false;
+
+	return Controller->IsLocalController() || (TrackRemotePlayers && Pawn->HasAuthority());
+}
+
+void UTargetLockTrackerComponent::UpdateWouldLockTarget()
+{
+	AActor* Owner = GetOwner();
+	if (!Owner || !Config) return;
+
+	FTargetLockScopedDebugTimer DebugTimer(this, ETargetLockDebugTimer::Acquisition);
+
+	const FStruct_TargetLockData& Data = Config->Data;
+	const FTargetLockViewPoint ViewPoint = UTargetLockUtilities::GetViewPoint(Owner, Camera.Get());
+
+	TArray<AActor*> Candidates;
+	UTargetLockUtilities::GatherCandidates(this, Data, Owner->GetActorLocation(), Data.MaxDistanceToStartTargetLock, Candidates);
+
+	//The current target gets the stickiness bonus, so the preview doesn't flicker between two equally good targets
+	SetWouldLockTarget(UTargetLockUtilities::SelectBestTarget(this, Data, Owner, ViewPoint, Candidates, false, WouldLockTarget.Get()));
+}
+
+AActor* UTargetLockTrackerComponent::GetValidWouldLockTarget() const
+{
+	AActor* Target = WouldLockTarget.Get();
+	const AActor* Owner = GetOwner();
+	if (!IsValid(Target) || !Owner || !Config) return nullptr;
+
+	const FStruct_TargetLockData& Data = Config->Data;
+	if (UTargetLockUtilities::HasUntargetableTag(Data, Target) || !UTargetLockUtilities::MatchesTargetTagQuery(Data, Target)) return nullptr;
+
+	const FTargetLockViewPoint ViewPoint = UTargetLockUtilities::GetViewPoint(Owner, Camera.Get());
+	const FVector TargetLocation = Target->GetActorLocation();
+	if (FVector::DistSquared(ViewPoint.Location, TargetLocation) > FMath::Square(Data.MaxDistanceToStartTargetLock)) return nullptr;
+
+	//The camera may have turned away since the last background search
+	if (Data.CullToViewFrustum && ViewPoint.HasFrustum())
+	{
+		bool bInside = false;
+		UTargetLockUtilities::TestViewFrustum(ViewPoint, Data.ViewFrustumInset, MakeArrayView(&TargetLocation, 1), MakeArrayView(&bInside, 1));
+		if (!bInside) return nullptr;
+	}
+	else if (UTargetLockUtilities::GetAngleToDirection(ViewPoint.Forward, TargetLocation - ViewPoint.Location) > Data.MaxAngleToTarget)
+	{
+		return nullptr;
+	}
+
+	return Target;
+}
+
+void UTargetLockTrackerComponent::SetWouldLockTarget(AActor* NewTarget)
+{
+	if (WouldLockTarget.Get() == NewTarget) return;
+
+	WouldLockTarget = NewTarget;
+	UpdatePreview();
+	OnWouldLockTargetChanged.Broadcast(NewTarget);
+}
+
+void UTargetLockTrackerComponent::UpdatePreview()
+{
+	RemovePreview();
+
+	AActor* Target = WouldLockTarget.Get();
+	if (!PreviewIndicatorMesh || !Target || !IsLocallyControlled()) return;
+
+	if (UTargetLockSubsystem* Subsystem = GetWorld()->GetSubsystem<UTargetLockSubsystem>())
+	{
+		PreviewIndicatorId = Subsystem->AddLockIndicator(PreviewIndicatorMesh, Target, PreviewIndicatorOffset, PreviewIndicatorScale);
+	}
+}
+
+void UTargetLockTrackerComponent::RemovePreview()
+{
+	if (PreviewIndicatorId == INDEX_NONE) return;
+
+	if (UWorld* World = GetWorld())
+	{
+		if (UTargetLockSubsystem* Subsystem = World->GetSubsystem<UTargetLockSubsystem>())
+		{
+			Subsystem->RemoveLockIndicator(PreviewIndicatorId);
+		}
+	}
+	PreviewIndicatorId = INDEX_NONE;
+}
+
+bool UTargetLockTrackerComponent::IsLocallyControlled() const
+{
+	const APawn* Pawn = Cast<APawn>(GetOwner());
+	return Pawn && Pawn->IsLocallyControlled();
+}
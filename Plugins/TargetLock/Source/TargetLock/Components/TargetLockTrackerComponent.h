@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TargetLockTrackerComponent.generated.h"
+
+class AController;
+class APawn;
+class UCameraComponent;
+class UStaticMesh;
+class UTargetLockConfig;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnWouldLockTargetChanged, AActor*, WouldLockTarget);
+
+/**
+ * Keeps searching the target its owner would lock onto at a low rate in the background.
+ * Locks started with the same config take the tracked target after a quick validity check instead of running a
+ * full search on the frame the button gets pressed, and the tracked target can be previewed with a reticle.
+ * Updates of different trackers are spread out over the update interval, so they don't all search in the same frame.
+ * Only runs while its pawn is controlled by a local player (see TrackRemotePlayers), it starts and stops with possession.
+ */
+UCLASS(ClassGroup = (TargetLock), meta = (BlueprintSpawnableComponent))
+class TARGETLOCK_API UTargetLockTrackerComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTargetLockTrackerComponent();
+
+	/**
+	 * The tracked target, if it is still valid: not destroyed, not untargetable, matching the tag query and still
+	 * within range and view.
+	 * Does no traces, the Line of Sight got checked by the last background search.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Target Lock")
+	AActor* GetValidWouldLockTarget() const;
+
+	//True if locks with this config can use the tracked target
+	bool IsTrackingFor(const UTargetLockConfig* LockConfig) const { return LockConfig && LockConfig == Config; }
+
+	//Searches the target right now instead of waiting for the next update
+	UFUNCTION(BlueprintCallable, Category = "Target Lock")
+	void UpdateWouldLockTarget();
+
+	//Broadcast when the tracked target changes, e.g. to show a preview in the UI
+	UPROPERTY(BlueprintAssignable, Category = "Target Lock")
+	FOnWouldLockTargetChanged OnWouldLockTargetChanged;
+
+	//The config used to search, locks need to use the same one to take the tracked target
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock")
+	TObjectPtr<UTargetLockConfig> Config;
+
+	//How often per second the target gets searched
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0.1", Units = "Hz"), Category = "Target Lock")
+	float UpdateRate = 5;
+
+	//Also track for the pawns of remote players on the server, only needed if their locks start on the server.
+	//AI controlled pawns never track, they search through the UBTService_TargetLock.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock")
+	bool TrackRemotePlayers = false;
+
+	//Optional: Drawn on the tracked target through the instanced indicators of the UTargetLockSubsystem. Local players only.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock|Preview")
+	TObjectPtr<UStaticMesh> PreviewIndicatorMesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock|Preview")
+	FVector PreviewIndicatorOffset = FVector(0, 0, 120);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock|Preview")
+	float PreviewIndicatorScale = 0.5f;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	UFUNCTION()
+	void OnControllerChanged(APawn* Pawn, AController* OldController, AController* NewController);
+
+	//Starts or stops the update timer, depending on who controls the owner now
+	void UpdateTracking();
+	bool ShouldTrack() const;
+
+	void SetWouldLockTarget(AActor* NewTarget);
+
+	void UpdatePreview();
+	void RemovePreview();
+
+	bool IsLocallyControlled() const;
+
+	TWeakObjectPtr<AActor> WouldLockTarget;
+
+	//Camera of the owner, looked up once
+	TWeakObjectPtr<UCameraComponent> Camera;
+
+	int32 PreviewIndicatorId = INDEX_NONE;
+
+	FTimerHandle UpdateTimerHandle;
+};
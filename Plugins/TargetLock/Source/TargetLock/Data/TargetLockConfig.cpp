@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Data/TargetLockConfig.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+
+void UTargetLockConfig::PostLoad()
+{
+	Super::PostLoad();
+
+	Data.Scoring.Bake();
+	UTargetLockSubsystem::CacheTargetTagQueryId(Data);
+}
+
+#if WITH_EDITOR
+void UTargetLockConfig::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	//Curves or the query may have been swapped
+	Data.Scoring.Bake();
+	UTargetLockSubsystem::CacheTargetTagQueryId(Data);
+}
+#endif
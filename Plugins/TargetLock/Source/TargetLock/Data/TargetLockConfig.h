@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "TargetLock/Data/TargetLockData.h"
+#include "TargetLockConfig.generated.h"
+
+/**
+ * Shared target lock configuration.
+ * Abilities, tasks and the UTargetLockSubsystem reference this asset by pointer, so any number of pawns
+ * can use the same configuration without each of them carrying its own copy of the lock data.
+ */
+UCLASS(BlueprintType)
+class TARGETLOCK_API UTargetLockConfig : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Target Lock")
+	FStruct_TargetLockData Data;
+};
@@ -0,0 +1,367 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "GameplayTagContainer.h"
+#include "TargetLock/Data/TargetLockScoring.h"
+#include "TargetLockData.generated.h"
+
+class UStaticMesh;
+class UTargetLockVisibilityProvider;
+
+UENUM(BlueprintType)
+enum class ETargetLockVisualizeMode : uint8
+{
+	//Uses a pooled actor of TargetLockVisualizeActorClass attached to the target
+	Actor,
+	//Draws TargetLockIndicatorMesh through the instanced indicator renderer of the UTargetLockSubsystem. Much cheaper when many locks are shown.
+	Instanced
+};
+
+UENUM(BlueprintType)
+enum class ETargetLockLineOfSightMode : uint8
+{
+	//Up to 49 line traces between points around the view point and the target, needs two of them to get through
+	RayPattern,
+	//One sphere sweep sized to the target towards its center, the ray pattern only runs if the sweep is blocked
+	Sweep
+};
+
+UENUM(BlueprintType)
+enum class ETargetLockCandidateSource : uint8
+{
+	//Physics overlap with the acquisition object types
+	Overlap,
+	//Candidate index of the UTargetLockSubsystem, kept up to date through level streaming and actor spawn/destroy.
+	//Doesn't need collision on the targets and keeps working while World Partition cells stream in and out.
+	CandidateIndex
+};
+
+//How Line of Sight traces collide with the world
+USTRUCT(BlueprintType)
+struct TARGETLOCK_API FTargetLockLineOfSightParams
+{
+	GENERATED_BODY()
+
+	//Channel the traces run on. Ignored if a profile is set.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+	//Collision profile the traces run with, takes priority over the channel.
+	//A profile that only static level geometry blocks makes every trace a lot cheaper in dense levels. The plugin ships none:
+	//add one to the collision profiles of the project, like "TargetLockOcclusion" in Config/DefaultEngine.ini of the sample project.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	FName TraceProfile = NAME_None;
+
+	//Trace against complex collision. Simple collision is much cheaper against detailed meshes.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	bool TraceComplex = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	ETargetLockLineOfSightMode Mode = ETargetLockLineOfSightMode::RayPattern;
+
+	//Radius of the sweep relative to the bounds radius of the target's root component.
+	//Smaller values let the sweep slip through narrower gaps but see less of the target.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "Mode == ETargetLockLineOfSightMode::Sweep", ClampMin = "0"), Category = "GAS|TargetLockData")
+	float SweepRadiusScale = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "Mode == ETargetLockLineOfSightMode::Sweep", Units = "CM"), Category = "GAS|TargetLockData")
+	float MaxSweepRadius = 50;
+};
+
+USTRUCT(BlueprintType)
+struct TARGETLOCK_API FStruct_TargetLockData
+{
+	GENERATED_BODY()
+
+	//Angle in Degrees
+	//The angle the rotation should not overstep
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "Deg"), Category = "GAS|TargetLockData")
+	float MaxAngleToTarget = 40;
+
+	//the angle where the rotation will start to go back towards the target
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "Deg"), Category = "GAS|TargetLockData")
+	float AngleToStartLerp = 15;
+
+	//Rotate Speed. 1 means it takes ~1 second to reach the desired rotation. Higher Values = Faster Rotation.
+	//Beware that very high values may result in overshooting because this value directly multiplies the value
+	//that gets added to the pitch/yaw 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	float RotateSpeed = 4;
+
+	//This ignores "RotateSpeed" by default. X < 1 makes it slower, X > 1 makes it faster.
+	//Beware that very high values may result in overshooting because this value directly multiplies the value
+	//that gets added to the pitch/yaw
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	float HardRotateSpeedMultiplier = 10;
+
+	//Rotate player controllers from a UCameraModifier_TargetLock inside the camera update instead of the task tick.
+	//The correction then uses the view of the frame being rendered, so the camera reacts without a frame of lag.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	bool RotateInCameraUpdate = false;
+
+	//How far away a unit is allowed to be eligible for target locking to be applied.
+	//This is measured in unreal units / cm.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "CM"), Category = "GAS|TargetLockData")
+	float MaxDistanceToStartTargetLock = 1500;
+
+	//How far away a locked target may get before the lock breaks. Keeping this above MaxDistanceToStartTargetLock
+	//stops locks at the edge of the range from breaking and being acquired again over and over.
+	//0 uses MaxDistanceToStartTargetLock.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "CM"), Category = "GAS|TargetLockData")
+	float MaxDistanceToKeepTargetLock = 0;
+
+	//Angle between the view direction and a locked target beyond which the lock breaks.
+	//0 means the lock never breaks because of the angle.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "Deg"), Category = "GAS|TargetLockData")
+	float MaxAngleToKeepTargetLock = 0;
+
+	//How long a locked target may stay out of range, out of angle or out of sight before the lock breaks.
+	//Getting back in time resets the timer. 0 breaks the lock right away.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "s", ClampMin = "0"), Category = "GAS|TargetLockData")
+	float LockBreakGraceTime = 0;
+
+	//Should we do a LineOfSight Check when we find our Target for the first time
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	bool DoLineOfSightCheck = false;
+
+	//Should we continuously check if the target is still in Line of Sight?
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	bool ContinuousLineOfSightCheck = false;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	TArray<TSubclassOf<AActor>> LockableClasses;
+
+	//Where the search for targets gets its candidates from
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	ETargetLockCandidateSource CandidateSource = ETargetLockCandidateSource::Overlap;
+
+	//Object types the search for targets overlaps. Defaults to WorldStatic and WorldDynamic.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "CandidateSource == ETargetLockCandidateSource::Overlap"), Category = "GAS|TargetLockData")
+	TArray<TEnumAsByte<EObjectTypeQuery>> AcquisitionObjectTypes = { ObjectTypeQuery1, ObjectTypeQuery2 };
+
+	//Searches requested through UTargetLockSubsystem::RequestAcquisition (e.g. by the Target Lock BT service) filter and score
+	//a snapshot of the candidates on a worker thread, and check Line of Sight with async traces. One ray per candidate
+	//instead of the ray pattern. The result arrives one frame later, or two with Line of Sight checks.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	bool AcquireOnWorkerThread = false;
+
+	//Collision used by the initial and the continuous Line of Sight checks
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "DoLineOfSightCheck || ContinuousLineOfSightCheck"), Category = "GAS|TargetLockData")
+	FTargetLockLineOfSightParams LineOfSightTrace;
+
+	//Pick the target with the best weighted score instead of simply the closest one
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	bool UseWeightedScoring = false;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "UseWeightedScoring"), Category = "GAS|TargetLockData")
+	FTargetLockScoring Scoring;
+
+	//Targets owning any of these tags (through their ability system component) can't be locked onto.
+	//An existing lock breaks the moment the target gains one of them, e.g. State.Untargetable.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	FGameplayTagContainer UntargetableTags;
+
+	//Only targets whose owned tags (through their ability system component) match this query can be locked onto,
+	//e.g. "has Team.Enemy and not State.Stealthed". Targets without ability system match an empty tag container.
+	//An empty query lets every target through.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	FGameplayTagQuery TargetTagQuery;
+
+	//Id of TargetTagQuery, see UTargetLockSubsystem::CacheTargetTagQueryId. Set when the config gets loaded or a task
+	//copies inline data. Searches register the query themselves while the generation doesn't match the registry.
+	int32 TargetTagQueryId = INDEX_NONE;
+	uint32 TargetTagQueryGeneration = 0;
+
+	//Only consider candidates inside the view frustum of the camera instead of the MaxAngleToTarget cone.
+	//Respects field of view and aspect ratio. View points without a camera keep using the cone.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	bool CullToViewFrustum = false;
+
+	//Makes the frustum smaller on every side so targets right at the screen edge or under the HUD are skipped. 0..1 of the half size.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "CullToViewFrustum", ClampMin = "0", ClampMax = "0.9"), Category = "GAS|TargetLockData")
+	float ViewFrustumInset = 0.05f;
+
+	//Skip candidates that weren't rendered recently before doing any Line of Sight check, they are most likely occluded.
+	//Only used for locally controlled players, what gets rendered is their view and not the one of AI or remote players.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "DoLineOfSightCheck"), Category = "GAS|TargetLockData")
+	bool SkipCandidatesNotRecentlyRendered = false;
+
+	//Optional: Vouches for targets that are visible without tracing, e.g. because the renderer drew them.
+	//Only the targets it can't vouch for get the Line of Sight traces.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Instanced, Category = "GAS|TargetLockData")
+	TObjectPtr<UTargetLockVisibilityProvider> VisibilityProvider;
+
+	//Skip the Line of Sight traces to targets that a baked ATargetLockVisibilityVolume knows to be hidden behind static geometry.
+	//Does nothing in levels without a baked volume. Opt in per config after checking the bake of the level, openings
+	//smaller than the MinOpeningSize of the volume count as closed.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "DoLineOfSightCheck || ContinuousLineOfSightCheck"), Category = "GAS|TargetLockData")
+	bool UseStaticVisibilityCache = false;
+
+	//Also lock onto the entities of the entity source of the UTargetLockSubsystem, e.g. Mass crowd agents (see the TargetLockMass plugin).
+	//Entities are scored like actors, but own no tags and are not seen by the visibility provider (see UTargetLockSubsystem::FindBestTargetHandle).
+	//Only locks run by the UTargetLockSubsystem support entity targets.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	bool LockOntoEntities = false;
+
+	//Break the lock when the target gets teleported
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	bool BreakLockOnTargetTeleport = false;
+
+	//Let the lock sleep while the target is inside AngleToStartLerp. A sleeping lock does no checks at all until
+	//the target or the view moved more than the wake thresholds, or SleepCheckInterval passed.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	bool SleepInDeadZone = false;
+
+	//How far the target or the view may move before a sleeping lock wakes up
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "SleepInDeadZone", Units = "CM", ClampMin = "0"), Category = "GAS|TargetLockData")
+	float SleepWakeDistance = 25;
+
+	//How far the view may turn before a sleeping lock wakes up
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "SleepInDeadZone", Units = "Deg", ClampMin = "0"), Category = "GAS|TargetLockData")
+	float SleepWakeAngle = 2;
+
+	//A sleeping lock still wakes up this often to check range, tags and Line of Sight
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "SleepInDeadZone", Units = "s", ClampMin = "0"), Category = "GAS|TargetLockData")
+	float SleepCheckInterval = 0.25f;
+	
+	//How the lock gets visualized on the target
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
+	ETargetLockVisualizeMode VisualizeMode = ETargetLockVisualizeMode::Actor;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "VisualizeMode == ETargetLockVisualizeMode::Actor"), Category = "GAS|TargetLockData")
+	TSubclassOf<AActor> TargetLockVisualizeActorClass;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "VisualizeMode == ETargetLockVisualizeMode::Instanced"), Category = "GAS|TargetLockData")
+	TObjectPtr<UStaticMesh> TargetLockIndicatorMesh;
+
+	//Offset from the target location the indicator is drawn at
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "VisualizeMode == ETargetLockVisualizeMode::Instanced"), Category = "GAS|TargetLockData")
+	FVector TargetLockIndicatorOffset = FVector::ZeroVector;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "VisualizeMode == ETargetLockVisualizeMode::Instanced"), Category = "GAS|TargetLockData")
+	float TargetLockIndicatorScale = 1;
+
+	//Distance at which an existing lock breaks, never below the distance to start one
+	float GetBreakDistance() const
+	{
+		return FMath::Max(MaxDistanceToKeepTargetLock, MaxDistanceToStartTargetLock);
+	}
+};
+
+//Refers to a lock that is run by the UTargetLockSubsystem. This is all a pawn has to hold on to for such a lock.
+USTRUCT(BlueprintType)
+struct TARGETLOCK_API FTargetLockHandle
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 Id = INDEX_NONE;
+
+	bool IsValid() const { return Id != INDEX_NONE; }
+
+	bool operator==(const FTargetLockHandle& Other) const { return Id == Other.Id; }
+	bool operator!=(const FTargetLockHandle& Other) const { return Id != Other.Id; }
+
+	friend uint32 GetTypeHash(const FTargetLockHandle& Handle) { return ::GetTypeHash(Handle.Id); }
+};
+
+//What a lock is locked onto. Either an actor or an entity of the entity source of the UTargetLockSubsystem,
+//e.g. a crowd agent of the TargetLockMass plugin that has no actor.
+USTRUCT(BlueprintType)
+struct TARGETLOCK_API FTargetLockTargetHandle
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Target Lock")
+	TWeakObjectPtr<AActor> Actor;
+
+	//Identify the entity, only meaningful to the entity source that handed them out
+	UPROPERTY()
+	int32 EntityIndex = INDEX_NONE;
+
+	UPROPERTY()
+	int32 EntitySerialNumber = 0;
+
+	static FTargetLockTargetHandle FromActor(AActor* InActor)
+	{
+		FTargetLockTargetHandle Handle;
+		Handle.Actor = InActor;
+		return Handle;
+	}
+
+	static FTargetLockTargetHandle FromEntity(int32 InIndex, int32 InSerialNumber)
+	{
+		FTargetLockTargetHandle Handle;
+		Handle.EntityIndex = InIndex;
+		Handle.EntitySerialNumber = InSerialNumber;
+		return Handle;
+	}
+
+	AActor* GetActor() const { return Actor.Get(); }
+
+	bool IsEntity() const { return EntityIndex != INDEX_NONE; }
+
+	//True if this refers to something, the actor may have been destroyed since
+	bool IsSet() const { return IsEntity() || !Actor.IsExplicitlyNull(); }
+
+	bool operator==(const FTargetLockTargetHandle& Other) const
+	{
+		return Actor == Other.Actor && EntityIndex == Other.EntityIndex && EntitySerialNumber == Other.EntitySerialNumber;
+	}
+	bool operator!=(const FTargetLockTargetHandle& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FTargetLockTargetHandle& Handle)
+	{
+		return HashCombine(GetTypeHash(Handle.Actor), HashCombine(::GetTypeHash(Handle.EntityIndex), ::GetTypeHash(Handle.EntitySerialNumber)));
+	}
+};
+
+//Where a locker looks from. The camera for players, the eyes (or whatever ITargetLockViewPointInterface returns) for AI.
+USTRUCT(BlueprintType)
+struct TARGETLOCK_API FTargetLockViewPoint
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock")
+	FVector Location = FVector::ZeroVector;
+
+	//Normalized view direction
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock")
+	FVector Forward = FVector::ForwardVector;
+
+	//Horizontal field of view, 0 if the view point has no frustum (e.g. AI eyes)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "Deg"), Category = "Target Lock")
+	float FieldOfView = 0;
+
+	//Width / height of the view
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock")
+	float AspectRatio = 0;
+
+	bool HasFrustum() const { return FieldOfView > 0 && AspectRatio > 0; }
+};
+
+class UTargetLockConfig;
+
+//One entry of a batched target acquisition (see UTargetLockSubsystem::FindBestTargetsBatch)
+USTRUCT(BlueprintType)
+struct TARGETLOCK_API FTargetLockLocker
+{
+	GENERATED_BODY()
+
+	//The actor looking for a target, it is never picked as its own target
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock")
+	TObjectPtr<AActor> Owner;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock")
+	FTargetLockViewPoint ViewPoint;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock")
+	TObjectPtr<UTargetLockConfig> Config;
+
+	//Optional: The target the locker currently has, it gets the Stickiness bonus of the weighted scoring
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Target Lock")
+	TObjectPtr<AActor> CurrentTarget;
+};
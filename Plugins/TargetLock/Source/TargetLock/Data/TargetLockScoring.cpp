@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Data/TargetLockScoring.h"
+#include "Curves/CurveFloat.h"
+
+namespace TargetLockScoring
+{
+	constexpr int32 LookupTableSize = 64;
+}
+
+void FTargetLockScoringCurve::Bake()
+{
+	LookupTable.Reset();
+	if (!Curve) return;
+
+	//The curve may be referenced from an asset that is just being loaded
+	Curve->ConditionalPostLoad();
+
+	LookupTable.SetNumUninitialized(TargetLockScoring::LookupTableSize);
+	for (int32 i = 0; i < TargetLockScoring::LookupTableSize; i++)
+	{
+		LookupTable[i] = Curve->GetFloatValue(static_cast<float>(i) / (TargetLockScoring::LookupTableSize - 1));
+	}
+}
+
+float FTargetLockScoringCurve::Evaluate(float Alpha) const
+{
+	Alpha = FMath::Clamp(Alpha, 0.f, 1.f);
+
+	if (LookupTable.Num() == 0)
+	{
+		//Not baked, e.g. a config built at runtime
+		return Curve ? Curve->GetFloatValue(Alpha) : Alpha;
+	}
+
+	const float Position = Alpha * (LookupTable.Num() - 1);
+	const int32 Index = FMath::Min(static_cast<int32>(Position), LookupTable.Num() - 2);
+	return FMath::Lerp(LookupTable[Index], LookupTable[Index + 1], Position - Index);
+}
+
+void FTargetLockScoringCurve::AddScores(TArrayView<const float> Alphas, TArrayView<float> InOutScores) const
+{
+	check(Alphas.Num() == InOutScores.Num());
+	if (Weight == 0) return;
+
+	if (!Curve)
+	{
+		for (int32 i = 0; i < Alphas.Num(); i++)
+		{
+			InOutScores[i] += Weight * FMath::Clamp(Alphas[i], 0.f, 1.f);
+		}
+		return;
+	}
+
+	for (int32 i = 0; i < Alphas.Num(); i++)
+	{
+		InOutScores[i] += Weight * Evaluate(Alphas[i]);
+	}
+}
+
+void FTargetLockScoring::Bake()
+{
+	Distance.Bake();
+	Angle.Bake();
+	Threat.Bake();
+	LastDamaged.Bake();
+}
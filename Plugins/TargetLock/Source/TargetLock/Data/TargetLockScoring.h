@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TargetLockScoring.generated.h"
+
+class UCurveFloat;
+
+//One criterion of the weighted target scoring
+USTRUCT(BlueprintType)
+struct TARGETLOCK_API FTargetLockScoringCurve
+{
+	GENERATED_BODY()
+
+	FTargetLockScoringCurve() = default;
+	explicit FTargetLockScoringCurve(float InWeight) : Weight(InWeight) {}
+
+	//Maps the criterion, normalized to 0..1, to a score. Without a curve the normalized criterion is used as is.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	TObjectPtr<UCurveFloat> Curve;
+
+	//How much this criterion counts. Negative values turn the criterion into a penalty, 0 skips it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	float Weight = 0;
+
+	//Samples the curve into the lookup table, so scoring doesn't have to evaluate the curve's keys per candidate
+	void Bake();
+
+	//True if Evaluate doesn't have to touch the curve, e.g. on a worker thread
+	bool IsBaked() const { return !Curve || LookupTable.Num() > 0; }
+
+	float Evaluate(float Alpha) const;
+
+	//Adds Weight * Evaluate(Alpha) to the score of every candidate
+	void AddScores(TArrayView<const float> Alphas, TArrayView<float> InOutScores) const;
+
+private:
+	TArray<float> LookupTable;
+};
+
+/**
+ * Weights of the criteria a target gets picked by. Every criterion is normalized to 0..1 per candidate
+ * and the candidate with the highest sum of weighted criteria wins.
+ * The curves get baked into lookup tables when the config is loaded (see Bake).
+ */
+USTRUCT(BlueprintType)
+struct TARGETLOCK_API FTargetLockScoring
+{
+	GENERATED_BODY()
+
+	//0 = at the view point, 1 = at MaxDistanceToStartTargetLock
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	FTargetLockScoringCurve Distance = FTargetLockScoringCurve(-1);
+
+	//0 = in the center of the view, 1 = at MaxAngleToTarget
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	FTargetLockScoringCurve Angle = FTargetLockScoringCurve(-1);
+
+	//Threat of the target towards the locker, see ITargetLockTargetInterface. 0 for targets not implementing it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	FTargetLockScoringCurve Threat;
+
+	//1 = damage was dealt between target and locker just now, 0 = not within LastDamagedWindow. See ITargetLockTargetInterface.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	FTargetLockScoringCurve LastDamaged;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "s"), Category = "GAS|TargetLockData")
+	float LastDamagedWindow = 5;
+
+	//Added to the score of the current target, so the lock doesn't jump between targets that score about the same
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
+	float Stickiness = 0.25f;
+
+	void Bake();
+
+	bool IsBaked() const { return Distance.IsBaked() && Angle.IsBaked() && Threat.IsBaked() && LastDamaged.IsBaked(); }
+};
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Data/TargetLockTagEventBinding.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+
+void FTargetLockTagEventBinding::Bind(const AActor* Target, const FGameplayTagContainer& Tags,
+	const FOnGameplayEffectTagCountChanged::FDelegate& Delegate)
+{
+	Unbind();
+	if (Tags.IsEmpty()) return;
+
+	UAbilitySystemComponent* TargetAbilitySystem = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Target);
+	if (!TargetAbilitySystem) return;
+
+	AbilitySystem = TargetAbilitySystem;
+	for (const FGameplayTag& Tag : Tags)
+	{
+		Handles.Emplace(Tag, TargetAbilitySystem->RegisterGameplayTagEvent(Tag, EGameplayTagEventType::NewOrRemoved).Add(Delegate));
+	}
+}
+
+void FTargetLockTagEventBinding::Unbind()
+{
+	if (UAbilitySystemComponent* TargetAbilitySystem = AbilitySystem.Get())
+	{
+		for (const TPair<FGameplayTag, FDelegateHandle>& Handle : Handles)
+		{
+			TargetAbilitySystem->RegisterGameplayTagEvent(Handle.Key, EGameplayTagEventType::NewOrRemoved).Remove(Handle.Value);
+		}
+	}
+	AbilitySystem.Reset();
+	Handles.Reset();
+}
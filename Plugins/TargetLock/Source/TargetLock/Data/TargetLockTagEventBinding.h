@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayEffectTypes.h"
+
+class UAbilitySystemComponent;
+
+/**
+ * Listens for tags being added to the ability system component of a lock target.
+ * Used to break locks the moment a target becomes untargetable instead of checking every tick.
+ */
+struct TARGETLOCK_API FTargetLockTagEventBinding
+{
+	//Binds the delegate to every tag of the container, does nothing if the target has no ability system component
+	void Bind(const AActor* Target, const FGameplayTagContainer& Tags, const FOnGameplayEffectTagCountChanged::FDelegate& Delegate);
+	void Unbind();
+
+	TWeakObjectPtr<UAbilitySystemComponent> AbilitySystem;
+	TArray<TPair<FGameplayTag, FDelegateHandle>> Handles;
+};
@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Debug/GameplayDebuggerCategory_TargetLock.h"
+
+#if WITH_GAMEPLAY_DEBUGGER
+
+#include "TargetLock/Debug/TargetLockDebugStats.h"
+#include "TargetLock/GAS/Tasks/GASTask_TargetLock.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+namespace TargetLockDebugger
+{
+	//Keeps the replicated shapes small, the counters still include every ray
+	constexpr int32 MaxDrawnRays = 128;
+}
+
+FGameplayDebuggerCategory_TargetLock::FGameplayDebuggerCategory_TargetLock()
+{
+	bShowOnlyWithDebugActor = false;
+	SetDataPackReplication<FRepData>(&DataPack);
+}
+
+TSharedRef<FGameplayDebuggerCategory> FGameplayDebuggerCategory_TargetLock::MakeInstance()
+{
+	return MakeShareable(new FGameplayDebuggerCategory_TargetLock());
+}
+
+void FGameplayDebuggerCategory_TargetLock::FRepData::Serialize(FArchive& Ar)
+{
+	Ar << SubsystemLocks;
+	Ar << LockSource;
+	Ar << TargetName;
+	Ar << bSleeping;
+
+	int32 NumCandidates = Candidates.Num();
+	Ar << NumCandidates;
+	if (Ar.IsLoading())
+	{
+		Candidates.SetNum(NumCandidates);
+	}
+	for (FRepCandidate& Candidate : Candidates)
+	{
+		Ar << Candidate.Name;
+		Ar << Candidate.DistanceAlpha;
+		Ar << Candidate.AngleAlpha;
+		Ar << Candidate.ThreatAlpha;
+		Ar << Candidate.DamagedAlpha;
+		Ar << Candidate.Score;
+	}
+
+	Ar << LineOfSightTraces;
+	Ar << SkippedTraces;
+	Ar << AcquisitionMicroseconds;
+	Ar << SolveMicroseconds;
+}
+
+void FGameplayDebuggerCategory_TargetLock::CollectData(APlayerController* OwnerPC, AActor* DebugActor)
+{
+	DataPack = FRepData();
+
+	UWorld* World = OwnerPC ? OwnerPC->GetWorld() : nullptr;
+	UTargetLockSubsystem* Subsystem = World ? World->GetSubsystem<UTargetLockSubsystem>() : nullptr;
+	if (!Subsystem) return;
+
+	//Keeps the subsystem collecting for as long as the category is shown
+	AActor* FocusActor = DebugActor ? DebugActor : OwnerPC->GetPawn();
+	Subsystem->RequestDebugStats(FocusActor);
+	DataPack.SubsystemLocks = Subsystem->GetActiveLockCount();
+
+	if (FocusActor)
+	{
+		const FTargetLockHandle Handle = Subsystem->FindLockByOwner(FocusActor);
+		if (Handle.IsValid())
+		{
+			const FTargetLockTargetHandle Target = Subsystem->GetLockTargetHandle(Handle);
+			DataPack.LockSource = TEXT("Subsystem");
+			DataPack.TargetName = Target.IsEntity() ? FString::Printf(TEXT("Entity %d"), Target.EntityIndex) : GetNameSafe(Target.GetActor());
+		}
+		else if (const UAbilitySystemComponent* AbilitySystem = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(FocusActor))
+		{
+			for (auto It = AbilitySystem->GetTickingTaskIterator(); It; ++It)
+			{
+				const UGASTask_TargetLock* Task = Cast<UGASTask_TargetLock>(*It);
+				if (!Task || !Task->IsLockingOnTarget()) continue;
+
+				DataPack.LockSource = TEXT("Ability Task");
+				DataPack.TargetName = GetNameSafe(Task->GetLockTarget());
+				DataPack.bSleeping = Task->IsSleeping();
+				break;
+			}
+		}
+	}
+
+	//Nothing collected before the first request
+	const FTargetLockDebugStats* Stats = Subsystem->GetDebugStats();
+	if (!Stats) return;
+
+	for (const FTargetLockDebugCandidate& Candidate : Stats->Candidates)
+	{
+		DataPack.Candidates.Add({ GetNameSafe(Candidate.Actor.Get()), Candidate.DistanceAlpha, Candidate.AngleAlpha,
+			Candidate.ThreatAlpha, Candidate.DamagedAlpha, Candidate.Score });
+	}
+
+	const FTargetLockFrameStats& LastFrame = Stats->LastFrame;
+	DataPack.LineOfSightTraces = LastFrame.LineOfSightTraces;
+	DataPack.SkippedTraces = LastFrame.SkippedTraces;
+	DataPack.AcquisitionMicroseconds = LastFrame.AcquisitionMicroseconds;
+	DataPack.SolveMicroseconds = LastFrame.SolveMicroseconds;
+
+	for (int32 i = 0; i < FMath::Min(LastFrame.Rays.Num(), TargetLockDebugger::MaxDrawnRays); i++)
+	{
+		const FTargetLockDebugRay& Ray = LastFrame.Rays[i];
+		AddShape(FGameplayDebuggerShape::MakeSegment(Ray.Start, Ray.End, 1.f, Ray.bBlocked ? FColor::Red : FColor::Green));
+	}
+}
+
+void FGameplayDebuggerCategory_TargetLock::DrawData(APlayerController* OwnerPC, FGameplayDebuggerCanvasContext& CanvasContext)
+{
+	CanvasContext.Printf(TEXT("{yellow}Subsystem locks: {white}%d"), DataPack.SubsystemLocks);
+
+	if (DataPack.LockSource.IsEmpty())
+	{
+		CanvasContext.Printf(TEXT("{yellow}Lock: {grey}none"));
+	}
+	else
+	{
+		CanvasContext.Printf(TEXT("{yellow}Lock: {white}%s {yellow}Target: {white}%s%s"), *DataPack.LockSource, *DataPack.TargetName,
+			DataPack.bSleeping ? TEXT(" {grey}(sleeping)") : TEXT(""));
+	}
+
+	if (DataPack.Candidates.Num() > 0)
+	{
+		CanvasContext.Printf(TEXT("{yellow}Last search{grey} (distance, angle, threat, damaged -> score)"));
+		for (const FRepCandidate& Candidate : DataPack.Candidates)
+		{
+			CanvasContext.Printf(TEXT("  {white}%s: {grey}%.2f, %.2f, %.2f, %.2f {white}-> %.3f"), *Candidate.Name,
+				Candidate.DistanceAlpha, Candidate.AngleAlpha, Candidate.ThreatAlpha, Candidate.DamagedAlpha, Candidate.Score);
+		}
+	}
+
+	CanvasContext.Printf(TEXT("{yellow}LoS traces: {white}%d {yellow}skipped: {white}%d"), DataPack.LineOfSightTraces, DataPack.SkippedTraces);
+	CanvasContext.Printf(TEXT("{yellow}Acquisition: {white}%.1f us {yellow}Solve: {white}%.1f us"),
+		DataPack.AcquisitionMicroseconds, DataPack.SolveMicroseconds);
+}
+
+#endif // WITH_GAMEPLAY_DEBUGGER
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#if WITH_GAMEPLAY_DEBUGGER
+
+#include "CoreMinimal.h"
+#include "GameplayDebuggerCategory.h"
+
+class AActor;
+class APlayerController;
+
+/**
+ * Shows the target locking of the debug actor and what target locking cost in the last frame:
+ * active locks, the current target, the score breakdown of the best candidates of the last search,
+ * the Line of Sight rays that actually ran, the traces skipped and the time spent searching and keeping locks.
+ * Collected on the server (or the standalone game) and replicated, so the server side cost can be looked at from a client.
+ */
+class FGameplayDebuggerCategory_TargetLock : public FGameplayDebuggerCategory
+{
+public:
+	FGameplayDebuggerCategory_TargetLock();
+
+	virtual void CollectData(APlayerController* OwnerPC, AActor* DebugActor) override;
+	virtual void DrawData(APlayerController* OwnerPC, FGameplayDebuggerCanvasContext& CanvasContext) override;
+
+	static TSharedRef<FGameplayDebuggerCategory> MakeInstance();
+
+protected:
+	struct FRepCandidate
+	{
+		FString Name;
+		float DistanceAlpha = 0;
+		float AngleAlpha = 0;
+		float ThreatAlpha = 0;
+		float DamagedAlpha = 0;
+		float Score = 0;
+	};
+
+	struct FRepData
+	{
+		int32 SubsystemLocks = 0;
+		FString LockSource;
+		FString TargetName;
+		bool bSleeping = false;
+
+		TArray<FRepCandidate> Candidates;
+
+		int32 LineOfSightTraces = 0;
+		int32 SkippedTraces = 0;
+		float AcquisitionMicroseconds = 0;
+		float SolveMicroseconds = 0;
+
+		void Serialize(FArchive& Ar);
+	};
+
+	FRepData DataPack;
+};
+
+#endif // WITH_GAMEPLAY_DEBUGGER
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Debug/TargetLockDebugStats.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+void FTargetLockDebugStats::EndFrame()
+{
+	LastFrame = MoveTemp(Current);
+	Current = FTargetLockFrameStats();
+	Current.Rays.Reserve(LastFrame.Rays.Num());
+}
+
+void FTargetLockDebugStats::AddRay(const FVector& Start, const FVector& End, bool bBlocked)
+{
+	Current.LineOfSightTraces++;
+	if (Current.Rays.Num() < MaxRays)
+	{
+		Current.Rays.Add({ Start, End, bBlocked });
+	}
+}
+
+int32 FTargetLockDebugStats::NumCollectingWorlds = 0;
+
+FTargetLockDebugStats* FTargetLockDebugStats::Get(const UObject* WorldContext)
+{
+#if WITH_GAMEPLAY_DEBUGGER
+	//Called for every trace, nearly always while nobody looks at the stats
+	if (NumCollectingWorlds == 0) return nullptr;
+
+	const UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull);
+	UTargetLockSubsystem* Subsystem = World ? World->GetSubsystem<UTargetLockSubsystem>() : nullptr;
+	return Subsystem ? Subsystem->GetDebugStats() : nullptr;
+#else
+	return nullptr;
+#endif
+}
+
+FTargetLockScopedDebugTimer::FTargetLockScopedDebugTimer(const UObject* WorldContext, ETargetLockDebugTimer InTimer)
+	: Timer(InTimer)
+{
+	Stats = FTargetLockDebugStats::Get(WorldContext);
+	if (Stats && Stats->TimerDepth[static_cast<int32>(Timer)]++ == 0)
+	{
+		StartCycles = FPlatformTime::Cycles64();
+	}
+}
+
+FTargetLockScopedDebugTimer::~FTargetLockScopedDebugTimer()
+{
+	if (!Stats || --Stats->TimerDepth[static_cast<int32>(Timer)] > 0) return;
+
+	const double Microseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0;
+	if (Timer == ETargetLockDebugTimer::Acquisition)
+	{
+		Stats->Current.AcquisitionMicroseconds += Microseconds;
+	}
+	else
+	{
+		Stats->Current.SolveMicroseconds += Microseconds;
+	}
+}
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+
+//A Line of Sight trace or sweep that actually ran
+struct TARGETLOCK_API FTargetLockDebugRay
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	bool bBlocked = false;
+};
+
+//Scoring of a candidate of the last search of the focus actor
+struct TARGETLOCK_API FTargetLockDebugCandidate
+{
+	TWeakObjectPtr<AActor> Actor;
+	float DistanceAlpha = 0;
+	float AngleAlpha = 0;
+	float ThreatAlpha = 0;
+	float DamagedAlpha = 0;
+	float Score = 0;
+};
+
+//Cost counters of one frame
+struct TARGETLOCK_API FTargetLockFrameStats
+{
+	int32 LineOfSightTraces = 0;
+
+	//Traces that didn't have to run because something already knew the answer, e.g. the visibility provider or the render hint
+	int32 SkippedTraces = 0;
+
+	double AcquisitionMicroseconds = 0;
+	double SolveMicroseconds = 0;
+
+	TArray<FTargetLockDebugRay> Rays;
+};
+
+enum class ETargetLockDebugTimer : uint8
+{
+	//Searching targets
+	Acquisition,
+	//Keeping locks: break checks and rotation
+	Solve
+};
+
+/**
+ * What target locking did and cost, shown by the TargetLock gameplay debugger category.
+ * Only collected while the category asks for it, see UTargetLockSubsystem::RequestDebugStats.
+ * Builds without the gameplay debugger never collect anything.
+ */
+struct TARGETLOCK_API FTargetLockDebugStats
+{
+	//Rays beyond this are counted but not kept for drawing
+	static constexpr int32 MaxRays = 256;
+	static constexpr int32 MaxCandidates = 5;
+
+	FTargetLockFrameStats Current;
+	FTargetLockFrameStats LastFrame;
+
+	//Search results are only kept for this actor, to show its score breakdown
+	TWeakObjectPtr<const AActor> FocusActor;
+	TArray<FTargetLockDebugCandidate> Candidates;
+
+	//Nesting of the scoped timers, so nested acquisitions aren't counted twice
+	int32 TimerDepth[2] = { 0, 0 };
+
+	//Moves the current counters to LastFrame
+	void EndFrame();
+
+	void AddRay(const FVector& Start, const FVector& End, bool bBlocked);
+
+	//The stats of the world of the context object, nullptr if nobody is collecting them
+	static FTargetLockDebugStats* Get(const UObject* WorldContext);
+
+	//Number of worlds collecting stats right now, Get doesn't look up any world while it is 0. Game thread only.
+	static int32 NumCollectingWorlds;
+};
+
+//Adds the time until it goes out of scope to the current frame stats, if they are being collected
+class TARGETLOCK_API FTargetLockScopedDebugTimer
+{
+public:
+	FTargetLockScopedDebugTimer(const UObject* WorldContext, ETargetLockDebugTimer InTimer);
+	~FTargetLockScopedDebugTimer();
+
+private:
+	FTargetLockDebugStats* Stats = nullptr;
+	ETargetLockDebugTimer Timer;
+	uint64 StartCycles = 0;
+};
@@ -42,12 +42,24 @@ void UGASAbility_TargetLock::ActivateAbility(const FGameplayAbilitySpecHandle Ha
 	}
 
 	//Start a new Target Lock
-	TargetLockTask = UGASTask_TargetLock::StartTargetLock(
-		this,
-		"TargetLockTask",
-		TargetLockData,
-		GetOwningActorFromActorInfo()
-		);
+	if (TargetLockConfig)
+	{
+		TargetLockTask = UGASTask_TargetLock::StartTargetLockWithConfig(
+			this,
+			"TargetLockTask",
+			TargetLockConfig,
+			GetOwningActorFromActorInfo()
+			);
+	}
+	else
+	{
+		TargetLockTask = UGASTask_TargetLock::StartTargetLock(
+			this,
+			"TargetLockTask",
+			TargetLockData,
+			GetOwningActorFromActorInfo()
+			);
+	}
 	
 	if (!TargetLockTask) //End Ability if something went wrong
 	{
@@ -7,6 +7,8 @@
 #include "TargetLock/GAS/Tasks/GASTask_TargetLock.h"
 #include "GASAbility_TargetLock.generated.h"
 
+class UTargetLockConfig;
+
 /**
  * This ability lets the given camera be rotated smoothly towards a target that gets chosen by the ability. 
  * This ability is nothing more than a runner for the task. However, we wanted to encapsulate it in an Ability to use the task like any other ability.
@@ -30,7 +32,12 @@ protected:
 	TObjectPtr<UGASTask_TargetLock> TargetLockTask;
 
 public:
+	//Shared configuration. If set, TargetLockData is ignored and the task only references this asset.
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Ability | Target Lock")
+	TObjectPtr<UTargetLockConfig> TargetLockConfig;
+
+	//Per ability configuration, only used if no TargetLockConfig is set
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (EditCondition = "TargetLockConfig == nullptr"), Category = "Ability | Target Lock")
 	FStruct_TargetLockData TargetLockData;
 	
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Ability | State")
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GASAbility_TargetLockShared.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "Engine/World.h"
+
+UGASAbility_TargetLockShared::UGASAbility_TargetLockShared(const class FObjectInitializer& Initializer)
+	: Super(Initializer)
+{
+	InstancingPolicy = EGameplayAbilityInstancingPolicy::Type::NonInstanced;
+	ReplicationPolicy = EGameplayAbilityReplicationPolicy::Type::ReplicateNo;
+}
+
+void UGASAbility_TargetLockShared::ActivateAbility(const FGameplayAbilitySpecHandle Handle,
+	const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo,
+	const FGameplayEventData* TriggerEventData)
+{
+	SCOPED_NAMED_EVENT_FSTRING(FString("Activate Shared Target Lock"), FColor::Green);
+	Super::ActivateAbility(Handle, ActorInfo, ActivationInfo, TriggerEventData);
+
+	AActor* Avatar = ActorInfo ? ActorInfo->AvatarActor.Get() : nullptr;
+	UWorld* World = Avatar ? Avatar->GetWorld() : nullptr;
+	UTargetLockSubsystem* Subsystem = World ? World->GetSubsystem<UTargetLockSubsystem>() : nullptr;
+
+	if (Subsystem)
+	{
+		//Toggle: stop the running lock or start a new one. The lock keeps running in the subsystem after the ability ended.
+		const FTargetLockHandle ActiveLock = Subsystem->FindLockByOwner(Avatar);
+		if (ActiveLock.IsValid())
+		{
+			Subsystem->StopLock(ActiveLock);
+		}
+		else
+		{
+			Subsystem->StartLock(Avatar, TargetLockConfig);
+		}
+	}
+
+	EndAbility(Handle, ActorInfo, ActivationInfo, false, false);
+}
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Abilities/GameplayAbility.h"
+#include "GASAbility_TargetLockShared.generated.h"
+
+class UTargetLockConfig;
+
+/**
+ * Non instanced variant of UGASAbility_TargetLock for pawns that come in large numbers.
+ * The ability itself only toggles a lock in the UTargetLockSubsystem, which runs the lock and holds its state.
+ * Every pawn shares the ability CDO and the config asset, so the per pawn cost is the lock handle in the subsystem.
+ */
+UCLASS(Abstract)
+class TARGETLOCK_API UGASAbility_TargetLockShared : public UGameplayAbility
+{
+	GENERATED_BODY()
+
+	UGASAbility_TargetLockShared(const class FObjectInitializer& Initializer);
+
+protected:
+	virtual void ActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, const FGameplayEventData* TriggerEventData) override;
+
+public:
+	//Shared by every pawn that has this ability
+	UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = "Ability | Target Lock")
+	TObjectPtr<UTargetLockConfig> TargetLockConfig;
+};
@@ -3,10 +3,15 @@
 
 #include "TargetLock/GAS/Tasks/GASTask_TargetLock.h"
 #include "TargetLockUtilities.h"
+#include "TargetLock/Data/TargetLockConfig.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "TargetLock/CameraModifiers/CameraModifier_TargetLock.h"
+#include "TargetLock/Debug/TargetLockDebugStats.h"
+#include "TargetLock/Components/TargetLockTrackerComponent.h"
+#include "Abilities/GameplayAbility.h"
+#include "AIController.h"
 #include "Kismet/GameplayStatics.h"
-#include "Kismet/KismetMathLibrary.h"
 #include "Engine/World.h"
-#include "Kismet/KismetSystemLibrary.h"
 
 UGASTask_TargetLock::UGASTask_TargetLock(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -14,31 +19,71 @@ UGASTask_TargetLock::UGASTask_TargetLock(const FObjectInitializer& ObjectInitial
 	bTickingTask = true;
 }
 
-UGASTask_TargetLock* UGASTask_TargetLock::StartTargetLock(UGameplayAbility* OwningAbility, FName TaskInstanceName, FStruct_TargetLockData TaskData, AActor* OptionalOwningActor, UCameraComponent* OptionalCamera)
+UGASTask_TargetLock* UGASTask_TargetLock::StartTargetLock(UGameplayAbility* OwningAbility, FName TaskInstanceName, const FStruct_TargetLockData& TaskData, AActor* OptionalOwningActor, UCameraComponent* OptionalCamera)
 {
+	//Search before creating the task, so a press without any target around doesn't leave a task behind for the GC.
+	//Unbaked scoring curves get evaluated directly, so the search doesn't need a baked copy of the data.
+	AActor* LockingActor = nullptr;
+	UCameraComponent* Camera = nullptr;
+	AActor* Target = AcquireTarget(OwningAbility, TaskData, nullptr, OptionalOwningActor, OptionalCamera, LockingActor, Camera);
+	if (!Target) return nullptr;
+
 	UGASTask_TargetLock* MyObj = NewAbilityTask<UGASTask_TargetLock>(OwningAbility, TaskInstanceName);
 	
 	MyObj->Configuration = TaskData;
-	
-	MyObj->SetupTargetLock(OptionalCamera, OptionalOwningActor);
-
-	if (!MyObj->CameraLockTarget)
+	if (MyObj->Configuration.UseWeightedScoring)
 	{
-		MyObj->ConditionalBeginDestroy();
-		return nullptr;
+		//Config assets bake their curves on load, the copy of inline data has to do it here
+		MyObj->Configuration.Scoring.Bake();
 	}
-	
+	UTargetLockSubsystem::CacheTargetTagQueryId(MyObj->Configuration);
+
+	MyObj->LockingActor = LockingActor;
+	MyObj->CameraComponent = Camera;
+	MyObj->CameraLockTarget = Target;
+	return MyObj;
+}
+
+UGASTask_TargetLock* UGASTask_TargetLock::StartTargetLockWithConfig(UGameplayAbility* OwningAbility, FName TaskInstanceName, UTargetLockConfig* Config, AActor* OptionalOwningActor, UCameraComponent* OptionalCamera)
+{
+	if (!Config) return nullptr;
+
+	AActor* LockingActor = nullptr;
+	UCameraComponent* Camera = nullptr;
+	AActor* Target = AcquireTarget(OwningAbility, Config->Data, Config, OptionalOwningActor, OptionalCamera, LockingActor, Camera);
+	if (!Target) return nullptr;
+
+	UGASTask_TargetLock* MyObj = NewAbilityTask<UGASTask_TargetLock>(OwningAbility, TaskInstanceName);
+
+	MyObj->ConfigAsset = Config;
+	MyObj->LockingActor = LockingActor;
+	MyObj->CameraComponent = Camera;
+	MyObj->CameraLockTarget = Target;
 	return MyObj;
 }
 
+AActor* UGASTask_TargetLock::FindTargetLockTarget(UGameplayAbility* OwningAbility, const FStruct_TargetLockData& TaskData, AActor* OptionalOwningActor, UCameraComponent* OptionalCamera)
+{
+	AActor* LockingActor = nullptr;
+	UCameraComponent* Camera = nullptr;
+	return AcquireTarget(OwningAbility, TaskData, nullptr, OptionalOwningActor, OptionalCamera, LockingActor, Camera);
+}
+
+const FStruct_TargetLockData& UGASTask_TargetLock::GetConfiguration() const
+{
+	return ConfigAsset ? ConfigAsset->Data : Configuration;
+}
+
 void UGASTask_TargetLock::Activate()
 {
 	Super::Activate();
 	
-	if (CameraLockTarget && Configuration.TargetLockVisualizeActorClass)
+	if (CameraLockTarget)
 	{
-		TargetLockVisualizeActor = GetWorld()->SpawnActor(Configuration.TargetLockVisualizeActorClass);
-		TargetLockVisualizeActor->AttachToActor(CameraLockTarget, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+		AcquireVisualization();
+		SetAIFocus(true);
+		SetCameraModifierActive(true);
+		BindTargetEvents();
 	}
 
 	if (!CameraLockTarget)
@@ -49,192 +94,323 @@ void UGASTask_TargetLock::Activate()
 
 void UGASTask_TargetLock::OnDestroy(bool bInOwnerFinished)
 {
+	WakeUp();
+	UnbindTargetEvents();
+	ReleaseVisualization();
+	SetAIFocus(false);
+	SetCameraModifierActive(false);
 	Super::OnDestroy(bInOwnerFinished);
-	if (TargetLockVisualizeActor)
+}
+
+void UGASTask_TargetLock::AcquireVisualization()
+{
+	UTargetLockSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UTargetLockSubsystem>() : nullptr;
+	if (!Subsystem) return;
+
+	const FStruct_TargetLockData& Config = GetConfiguration();
+	switch (Config.VisualizeMode)
+	{
+	case ETargetLockVisualizeMode::Actor:
+		//Visualize actors are pooled per world, so toggling the lock doesn't spawn anything once the pool is warm
+		TargetLockVisualizeActor = Subsystem->AcquireVisualizeActor(Config.TargetLockVisualizeActorClass, CameraLockTarget);
+		break;
+	case ETargetLockVisualizeMode::Instanced:
+		TargetLockIndicatorId = Subsystem->AddLockIndicator(Config.TargetLockIndicatorMesh, CameraLockTarget,
+			Config.TargetLockIndicatorOffset, Config.TargetLockIndicatorScale);
+		break;
+	}
+}
+
+void UGASTask_TargetLock::ReleaseVisualization()
+{
+	if (!TargetLockVisualizeActor && TargetLockIndicatorId == INDEX_NONE) return;
+
+	if (UWorld* World = GetWorld())
 	{
-		TargetLockVisualizeActor->Destroy();
+		if (UTargetLockSubsystem* Subsystem = World->GetSubsystem<UTargetLockSubsystem>())
+		{
+			Subsystem->ReleaseVisualizeActor(TargetLockVisualizeActor);
+			Subsystem->RemoveLockIndicator(TargetLockIndicatorId);
+		}
 	}
+	TargetLockVisualizeActor = nullptr;
+	TargetLockIndicatorId = INDEX_NONE;
 }
 
 void UGASTask_TargetLock::TickTask(float DeltaTime)
 {
 	Super::TickTask(DeltaTime);
 
+	//A sleeping lock only counts down to its next check, the transform callbacks wake it up earlier if needed
+	if (bSleeping)
+	{
+		SleepTime += DeltaTime;
+		if (SleepTime < GetConfiguration().SleepCheckInterval) return;
+
+		WakeUp();
+	}
+
 	LerpTargetLocked(DeltaTime);
 }
 
-void UGASTask_TargetLock::SetupTargetLock(UCameraComponent* OptionalCam, AActor* OptionalOwner)
+AActor* UGASTask_TargetLock::AcquireTarget(const UGameplayAbility* OwningAbility, const FStruct_TargetLockData& Config, const UTargetLockConfig* ConfigAsset,
+	AActor* OptionalOwner, UCameraComponent* OptionalCam, AActor*& OutLockingActor, UCameraComponent*& OutCamera)
 {
-	
-	AActor* OwningActor = nullptr;
-	if (OptionalOwner)
+	//The task would be owned by the ability, which hands out its owning actor as task owner
+	AActor* OwningActor = OptionalOwner;
+	if (!OwningActor && OwningAbility)
+	{
+		OwningActor = OwningAbility->GetOwningActorFromActorInfo();
+	}
+
+	if (!OwningActor) return nullptr;
+	OutLockingActor = OwningActor;
+
+	if (OptionalCam)
 	{
-		OwningActor = OptionalOwner;
+		OutCamera = OptionalCam;
 	}
 	else
 	{
-		OwningActor = GetOwnerActor();
+		OutCamera = OwningActor->FindComponentByClass<UCameraComponent>();
 	}
 
-	if (OptionalCam)
+	//The background tracker already did the search, only its result has to be checked
+	if (const UTargetLockTrackerComponent* Tracker = OwningActor->FindComponentByClass<UTargetLockTrackerComponent>())
 	{
-		CameraComponent = OptionalCam;
+		if (Tracker->IsTrackingFor(ConfigAsset))
+		{
+			if (AActor* Target = Tracker->GetValidWouldLockTarget())
+			{
+				return Target;
+			}
+		}
+	}
+
+	return UTargetLockUtilities::FindBestTarget(OwningActor, Config, OwningActor, OutCamera);
+}
+
+AController* UGASTask_TargetLock::GetLockController() const
+{
+	if (AController* Controller = UTargetLockUtilities::GetLockController(LockingActor))
+	{
+		return Controller;
+	}
+	return UGameplayStatics::GetPlayerController(this, 0);
+}
+
+void UGASTask_TargetLock::SetAIFocus(bool bFocusTarget)
+{
+	AAIController* AIController = Cast<AAIController>(UTargetLockUtilities::GetLockController(LockingActor));
+	if (!AIController) return;
+
+	if (bFocusTarget && CameraLockTarget)
+	{
+		AIController->SetFocus(CameraLockTarget, EAIFocusPriority::Gameplay);
 	}
 	else
 	{
-		CameraComponent = Cast<UCameraComponent>(OwningActor->GetComponentByClass(UCameraComponent::StaticClass()));
+		AIController->ClearFocus(EAIFocusPriority::Gameplay);
 	}
-	
-	FVector CameraLocation = CameraComponent->GetComponentLocation();
-	FVector CameraForward = CameraComponent->GetForwardVector();
+}
 
-	//Setup possible targets
-	TArray<AActor*> PossibleTargets{};
-	TArray<AActor*> TempTargets{};
-	for (TSubclassOf<AActor> LockClass : Configuration.LockableClasses)
+void UGASTask_TargetLock::SetCameraModifierActive(bool bActive)
+{
+	if (!bActive)
 	{
-		UKismetSystemLibrary::SphereOverlapActors(this,
-			OwningActor->GetActorLocation(),
-			Configuration.MaxDistanceToStartTargetLock,
-			{ UEngineTypes::ConvertToObjectType(ECollisionChannel::ECC_WorldDynamic), UEngineTypes::ConvertToObjectType(ECollisionChannel::ECC_WorldStatic) },
-			LockClass,
-			{},
-			TempTargets);
-
-		if (TempTargets.Num() > 0)
+		if (UCameraModifier_TargetLock* Modifier = CameraModifier.Get())
 		{
-			PossibleTargets.Append(TempTargets);
+			Modifier->ClearLockTarget(CameraLockTarget);
 		}
-		TempTargets.Empty();
+		CameraModifier.Reset();
+		return;
 	}
-	
 
-	//Find best target
-	AActor* Target = nullptr;
-	float ClosestTarget = FLT_MAX;
-	for (AActor* Actor : PossibleTargets)
+	const FStruct_TargetLockData& Config = GetConfiguration();
+	if (!Config.RotateInCameraUpdate || !CameraLockTarget) return;
+
+	//Only player controllers have a camera manager, everything else keeps rotating from the task tick
+	if (UCameraModifier_TargetLock* Modifier = UCameraModifier_TargetLock::FindOrAdd(GetLockController()))
 	{
-		float dist = FVector::Dist(CameraLocation, Actor->GetActorLocation());
-		if (dist >= ClosestTarget && dist > Configuration.MaxDistanceToStartTargetLock) continue;
+		Modifier->SetLockTarget(CameraLockTarget, Config);
+		CameraModifier = Modifier;
+	}
+}
+
+void UGASTask_TargetLock::BindTargetEvents()
+{
+	UnbindTargetEvents();
+	if (!CameraLockTarget) return;
+
+	BoundTarget = CameraLockTarget;
+	CameraLockTarget->OnDestroyed.AddUniqueDynamic(this, &UGASTask_TargetLock::OnLockTargetDestroyed);
+	CameraLockTarget->OnEndPlay.AddUniqueDynamic(this, &UGASTask_TargetLock::OnLockTargetEndPlay);
+
+	const FStruct_TargetLockData& Config = GetConfiguration();
+	TargetTagEvents.Bind(CameraLockTarget, Config.UntargetableTags,
+		FOnGameplayEffectTagCountChanged::FDelegate::CreateUObject(this, &UGASTask_TargetLock::OnLockTargetTagChanged));
+
+	if (Config.BreakLockOnTargetTeleport)
+	{
+		if (USceneComponent* TargetRoot = CameraLockTarget->GetRootComponent())
+		{
+			TargetTransformUpdatedHandle = TargetRoot->TransformUpdated.AddUObject(this, &UGASTask_TargetLock::OnLockTargetTransformUpdated);
+		}
+	}
+}
+
+void UGASTask_TargetLock::UnbindTargetEvents()
+{
+	TargetTagEvents.Unbind();
 
-		FVector Direction = Actor->GetActorLocation() - CameraLocation;
-		float Angle = UTargetLockUtilities::GetAngleToDirection(CameraForward, Direction);
-		if (Angle > Configuration.MaxAngleToTarget) continue;
+	if (AActor* Target = BoundTarget.Get())
+	{
+		Target->OnDestroyed.RemoveDynamic(this, &UGASTask_TargetLock::OnLockTargetDestroyed);
+		Target->OnEndPlay.RemoveDynamic(this, &UGASTask_TargetLock::OnLockTargetEndPlay);
 
-		if (dist < Configuration.MaxDistanceToStartTargetLock && dist < ClosestTarget)
+		if (USceneComponent* TargetRoot = Target->GetRootComponent())
 		{
-			const TArray<AActor*> IgnoreList{ Actor, OwningActor };
-			
-			if(Configuration.DoLineOfSightCheck && !(UTargetLockUtilities::LineOfSightCheckFromCompToActor(this, CameraComponent, Actor, IgnoreList, 75) ||
-				UTargetLockUtilities::LineOfSightCheckFromActorToActor(this, OwningActor, Actor, IgnoreList, 75)))
-				continue;
-
-			ClosestTarget = dist;
-			Target = Actor;
+			TargetRoot->TransformUpdated.Remove(TargetTransformUpdatedHandle);
 		}
 	}
+	TargetTransformUpdatedHandle.Reset();
+	BoundTarget.Reset();
+}
 
-	//Apply Lock Target, if this is still null here it will end the task at the start of the first tick
-	CameraLockTarget = Target;
+void UGASTask_TargetLock::OnLockTargetDestroyed(AActor* DestroyedActor)
+{
+	StopTask_Implementation();
+}
+
+void UGASTask_TargetLock::OnLockTargetEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	StopTask_Implementation();
+}
+
+void UGASTask_TargetLock::OnLockTargetTagChanged(const FGameplayTag Tag, int32 NewCount)
+{
+	if (NewCount > 0)
+	{
+		StopTask_Implementation();
+	}
+}
+
+void UGASTask_TargetLock::OnLockTargetTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (Teleport != ETeleportType::None)
+	{
+		StopTask_Implementation();
+	}
 }
 
 void UGASTask_TargetLock::LerpTargetLocked(double DeltaTime)
 {
 	//Check if Data is Valid
-	if (!CameraLockTarget || !CameraComponent)
+	if (!CameraLockTarget || !LockingActor)
 	{
 		StopTask_Implementation();
 		return;
 	}
 
-	//Do a Line of Sight Check, if required
-	if (Configuration.ContinuousLineOfSightCheck)
+	FTargetLockScopedDebugTimer DebugTimer(this, ETargetLockDebugTimer::Solve);
+
+	const FStruct_TargetLockData& Config = GetConfiguration();
+	const FTargetLockViewPoint ViewPoint = UTargetLockUtilities::GetViewPoint(LockingActor, CameraComponent);
+
+	//Range, angle and Line of Sight only break the lock once they failed for the whole grace time
+	const bool bStillLockable = UTargetLockUtilities::IsTargetStillLockable(this, Config, LockingActor, ViewPoint, CameraLockTarget);
+	if (UTargetLockUtilities::UpdateLockBreakTimer(Config, bStillLockable, DeltaTime, LockBreakTimer))
 	{
-		if (!UTargetLockUtilities::LineOfSightCheckFromCompToActor(this,
-			Cast<USceneComponent>(this), CameraLockTarget,
-			{ CameraComponent->GetOwner(), CameraLockTarget }, 75) &&
-			!UTargetLockUtilities::LineOfSightCheckFromActorToActor(this,
-				CameraComponent->GetOwner(), CameraLockTarget,
-				{ CameraComponent->GetOwner(), CameraLockTarget }, 75))
-		{
-			StopTask_Implementation();
-			return;
-		}
+		StopTask_Implementation();
+		return;
 	}
 
-	//Setup Calculation Data
-	const FVector CameraLocation = CameraComponent->GetComponentLocation();
-	const FVector TargetLocation = CameraLockTarget->GetActorLocation();
-	const FVector CameraDirection = CameraComponent->GetForwardVector() * FVector::Dist(CameraLocation, TargetLocation);
-	const FVector TargetDirection = TargetLocation - CameraLocation;
+	AController* Controller = GetLockController();
+	if (!Controller) return;
 
-	//this vector is perpendicular to TargetLocation
-	const FVector ProjectedVector = UKismetMathLibrary::ProjectVectorOnToVector(TargetDirection, CameraDirection);
+	//The focus of the AI controller does the rotating
+	if (Controller->IsA<AAIController>()) return;
 
-	const float Angle = UTargetLockUtilities::GetAngleToDirection(TargetDirection, CameraDirection);
+	float Angle = 0;
+	const FRotator RotationDelta = UTargetLockUtilities::ComputeLockRotationDelta(Config, ViewPoint.Location,
+		ViewPoint.Forward, CameraLockTarget->GetActorLocation(), Controller->GetControlRotation(), DeltaTime, Angle);
 
 	//Early Return if we don't need any additional rotation
-	if (Angle < Configuration.AngleToStartLerp)
+	if (Angle < Config.AngleToStartLerp)
 	{
+		//Nothing to do until the target or the view moves, unless the lock is about to break
+		if (Config.SleepInDeadZone && LockBreakTimer == 0)
+		{
+			Sleep();
+		}
 		return;
 	}
 
-	//Stop Target Lock if Target is outside range
-	if (FVector::Dist(CameraComponent->GetComponentLocation(), CameraLockTarget->GetActorLocation()) > Configuration.MaxDistanceToStartTargetLock)
-	{
-		StopTask_Implementation();
-		return;
-	}
+	//The camera modifier applies the rotation during the camera update
+	if (CameraModifier.IsValid()) return;
 
-	//Create a Look At Target based on the projected vector to rotate camera towards
-	FVector NormalizedAngledDirection = TargetLocation - (ProjectedVector + CameraLocation);
-	NormalizedAngledDirection.Normalize();
+	Controller->SetControlRotation(Controller->GetControlRotation() + RotationDelta);
+}
 
-	float DistFromProjectedToTarget = FVector::Dist(CameraLocation + (FVector::DownVector * 100) + ProjectedVector, TargetLocation);
+void UGASTask_TargetLock::Sleep()
+{
+	WakeUp();
+
+	USceneComponent* TargetRoot = CameraLockTarget ? CameraLockTarget->GetRootComponent() : nullptr;
+	USceneComponent* ViewComponent = CameraComponent ? CameraComponent.Get() : (LockingActor ? LockingActor->GetRootComponent() : nullptr);
+	if (!TargetRoot || !ViewComponent) return;
+
+	bSleeping = true;
+	SleepTime = 0;
+	SleepTargetLocation = TargetRoot->GetComponentLocation();
+	SleepViewLocation = ViewComponent->GetComponentLocation();
+	SleepViewForward = ViewComponent->GetForwardVector();
+
+	SleepTargetComponent = TargetRoot;
+	SleepViewComponent = ViewComponent;
+	SleepTargetTransformHandle = TargetRoot->TransformUpdated.AddUObject(this, &UGASTask_TargetLock::OnSleepTransformUpdated);
+	SleepViewTransformHandle = ViewComponent->TransformUpdated.AddUObject(this, &UGASTask_TargetLock::OnSleepTransformUpdated);
+}
 
-	const FVector SoftRotationLookAtTarget = (NormalizedAngledDirection * (asin((Angle - Configuration.AngleToStartLerp) * (PI / 180)) * TargetDirection.Length()));
-	const FVector HardRotationLookAtTarget = (NormalizedAngledDirection * (asin((Angle - Configuration.MaxAngleToTarget) * (PI / 180)) * TargetDirection.Length()));
+void UGASTask_TargetLock::WakeUp()
+{
+	if (USceneComponent* TargetRoot = SleepTargetComponent.Get())
+	{
+		TargetRoot->TransformUpdated.Remove(SleepTargetTransformHandle);
+	}
+	if (USceneComponent* ViewComponent = SleepViewComponent.Get())
+	{
+		ViewComponent->TransformUpdated.Remove(SleepViewTransformHandle);
+	}
+	SleepTargetTransformHandle.Reset();
+	SleepViewTransformHandle.Reset();
+	SleepTargetComponent.Reset();
+	SleepViewComponent.Reset();
 
-	//These are the desired points based on our rotation to the target. 
-	const FRotator TargetSoftRotator = UKismetMathLibrary::FindLookAtRotation(CameraLocation, CameraLocation + ProjectedVector + SoftRotationLookAtTarget);
-	const FRotator TargetHardRotator = UKismetMathLibrary::FindLookAtRotation(CameraLocation, CameraLocation + ProjectedVector + HardRotationLookAtTarget);
+	bSleeping = false;
+}
+
+void UGASTask_TargetLock::OnSleepTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (!bSleeping || !UpdatedComponent) return;
 
-	APlayerController* Controller = UGameplayStatics::GetPlayerController(this, 0);
+	const FStruct_TargetLockData& Config = GetConfiguration();
+	const float WakeDistanceSquared = FMath::Square(Config.SleepWakeDistance);
 
-	//Do the hard rotation, if needed based on our look at angle to the target
-	if (Angle >= Configuration.MaxAngleToTarget)
+	bool bWakeUp = Teleport != ETeleportType::None;
+	if (UpdatedComponent == SleepTargetComponent.Get())
 	{
-		const float TargetYaw = TargetHardRotator.Yaw;
-		float ControllerYaw = Controller->GetControlRotation().Yaw;
-		float CalcYaw = UTargetLockUtilities::FindRotationAddition(TargetYaw, ControllerYaw);
-		CalcYaw *= DeltaTime * Configuration.HardRotateSpeedMultiplier;
-		
-		const float TargetPitch = TargetHardRotator.Pitch;
-		float ControllerPitch = Controller->GetControlRotation().Pitch;
-		float CalcPitch = UTargetLockUtilities::FindRotationAddition(TargetPitch, ControllerPitch);
-		CalcPitch *= DeltaTime * Configuration.HardRotateSpeedMultiplier;
-
-		//Forcefully rotate Camera
-		Controller->SetControlRotation(Controller->GetControlRotation() + FRotator(CalcPitch, CalcYaw, 0));
-		
+		bWakeUp |= FVector::DistSquared(UpdatedComponent->GetComponentLocation(), SleepTargetLocation) > WakeDistanceSquared;
 	}
-	
-	//Do the smooth rotation towards the target
-	if (Angle >= Configuration.AngleToStartLerp)
+	else
+	{
+		bWakeUp |= FVector::DistSquared(UpdatedComponent->GetComponentLocation(), SleepViewLocation) > WakeDistanceSquared;
+		bWakeUp |= FVector::DotProduct(UpdatedComponent->GetForwardVector(), SleepViewForward) < FMath::Cos(FMath::DegreesToRadians(Config.SleepWakeAngle));
+	}
+
+	if (bWakeUp)
 	{
-		//Make smooth yaw input
-		const float TargetYaw = TargetSoftRotator.Yaw;
-		float ControllerYaw = Controller->GetControlRotation().Yaw;
-		float CalcYaw = UTargetLockUtilities::FindRotationAddition(TargetYaw, ControllerYaw);
-		CalcYaw *= Configuration.RotateSpeed * DeltaTime;
-		
-		//make smooth pitch input
-		const float TargetPitch = TargetSoftRotator.Pitch;
-		float ControllerPitch = Controller->GetControlRotation().Pitch;
-		float CalcPitch = UTargetLockUtilities::FindRotationAddition(TargetPitch, ControllerPitch);
-		CalcPitch *= Configuration.RotateSpeed * DeltaTime;
-
-		Controller->SetControlRotation(Controller->GetControlRotation() + FRotator(CalcPitch, CalcYaw, 0));
+		WakeUp();
 	}
 }
 
@@ -245,12 +421,13 @@ bool UGASTask_TargetLock::IsLockingOnTarget() const
 
 void UGASTask_TargetLock::StopTask_Implementation()
 {
-	if (TargetLockVisualizeActor)
-	{
-		TargetLockVisualizeActor->Destroy();
-	}
+	WakeUp();
+	UnbindTargetEvents();
+	ReleaseVisualization();
+	SetAIFocus(false);
+	SetCameraModifierActive(false);
 	CameraLockTarget = nullptr;
 	CameraComponent = nullptr;
 	OnTaskEnded.Broadcast();
 	EndTask();
-}
\ No newline at end of file
+}
@@ -6,53 +6,12 @@
 #include "GASTask_EndingAbilityTask.h"
 #include "Abilities/Tasks/AbilityTask.h"
 #include "Camera/CameraComponent.h"
+#include "TargetLock/Data/TargetLockData.h"
+#include "TargetLock/Data/TargetLockTagEventBinding.h"
 #include "GASTask_TargetLock.generated.h"
 
-USTRUCT(BlueprintType)
-struct TARGETLOCK_API FStruct_TargetLockData
-{
-	GENERATED_BODY()
-
-	//Angle in Degrees
-	//The angle the rotation should not overstep
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "Deg"), Category = "GAS|TargetLockData")
-	float MaxAngleToTarget = 40;
-
-	//the angle where the rotation will start to go back towards the target
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "Deg"), Category = "GAS|TargetLockData")
-	float AngleToStartLerp = 15;
-
-	//Rotate Speed. 1 means it takes ~1 second to reach the desired rotation. Higher Values = Faster Rotation.
-	//Beware that very high values may result in overshooting because this value directly multiplies the value
-	//that gets added to the pitch/yaw 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
-	float RotateSpeed = 4;
-
-	//This ignores "RotateSpeed" by default. X < 1 makes it slower, X > 1 makes it faster.
-	//Beware that very high values may result in overshooting because this value directly multiplies the value
-	//that gets added to the pitch/yaw
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
-	float HardRotateSpeedMultiplier = 10;
-
-	//How far away a unit is allowed to be eligible for target locking to be applied.
-	//This is measured in unreal units / cm.
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (Units = "CM"), Category = "GAS|TargetLockData")
-	float MaxDistanceToStartTargetLock = 1500;
-
-	//Should we do a LineOfSight Check when we find our Target for the first time
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
-	bool DoLineOfSightCheck = false;
-
-	//Should we continuously check if the target is still in Line of Sight?
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS|TargetLockData")
-	bool ContinuousLineOfSightCheck = false;
-
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
-	TArray<TSubclassOf<AActor>> LockableClasses;
-	
-	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GAS|TargetLockData")
-	TSubclassOf<AActor> TargetLockVisualizeActorClass;
-};
+class UTargetLockConfig;
+class UCameraModifier_TargetLock;
 
 /**
  * 
@@ -78,9 +37,51 @@ public:
 	static UGASTask_TargetLock* StartTargetLock(
 			UGameplayAbility* OwningAbility,
 			FName TaskInstanceName,
-			FStruct_TargetLockData TaskData,
+			const FStruct_TargetLockData& TaskData,
+			AActor* OptionalOwningActor = nullptr,
+			UCameraComponent* OptionalCamera= nullptr);
+
+	/**
+	 * Same as StartTargetLock, but references a shared config asset instead of copying the lock data into the task.
+	 *
+	 * @param OwningAbility The Ability that owns this task.
+	 * @param TaskInstanceName The name of the task, can be anything.
+	 * @param Config The shared configuration to use for the target lock. Required.
+	 * @param OptionalOwningActor Optional: See StartTargetLock.
+	 * @param OptionalCamera Optional: See StartTargetLock.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Ability|Tasks", meta = (HidePin = "OwningAbility", DefaultToSelf = "OwningAbility", BlueprintInternalUseOnly = "True"))
+	static UGASTask_TargetLock* StartTargetLockWithConfig(
+			UGameplayAbility* OwningAbility,
+			FName TaskInstanceName,
+			UTargetLockConfig* Config,
 			AActor* OptionalOwningActor = nullptr,
 			UCameraComponent* OptionalCamera= nullptr);
+
+	/**
+	 * Searches the target a lock started with the same parameters would lock onto, without creating a task.
+	 * StartTargetLock does this before it creates the task, so a search that finds nothing leaves nothing behind.
+	 *
+	 * @param OwningAbility The Ability that would own the task.
+	 * @param TaskData The data the lock would use.
+	 * @param OptionalOwningActor Optional: See StartTargetLock.
+	 * @param OptionalCamera Optional: See StartTargetLock.
+	 * @return The target or nullptr if there is none.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Ability|Tasks", meta = (HidePin = "OwningAbility", DefaultToSelf = "OwningAbility"))
+	static AActor* FindTargetLockTarget(
+			UGameplayAbility* OwningAbility,
+			const FStruct_TargetLockData& TaskData,
+			AActor* OptionalOwningActor = nullptr,
+			UCameraComponent* OptionalCamera = nullptr);
+
+	//The configuration in use. Either the one of the shared config asset or the task's own copy.
+	const FStruct_TargetLockData& GetConfiguration() const;
+
+	AActor* GetLockTarget() const { return CameraLockTarget; }
+
+	//True while the target is inside the dead zone and the lock does no work, see Sleep
+	bool IsSleeping() const { return bSleeping; }
 	
 protected:
 	virtual void TickTask(float DeltaTime) override;
@@ -90,27 +91,105 @@ protected:
 
 	virtual void OnDestroy(bool bInOwnerFinished) override;
 
-	//Sets up the data, receives the camera component of the player and searches for a
-	//UClass_BaseEnemy to target. These things may get exposed in the future.
-	void SetupTargetLock(UCameraComponent* OptionalCam = nullptr, AActor* OptionalOwner = nullptr);
+	//Finds the actor locking on and its camera and searches a target for it. Runs before the task gets created.
+	//Without a camera the lock runs camera-less and looks from the view point of the owner (see UTargetLockUtilities::GetViewPoint).
+	//If the owner has a UTargetLockTrackerComponent tracking for the ConfigAsset, its target is taken without a search.
+	static AActor* AcquireTarget(const UGameplayAbility* OwningAbility, const FStruct_TargetLockData& Config, const UTargetLockConfig* ConfigAsset,
+		AActor* OptionalOwner, UCameraComponent* OptionalCam, AActor*& OutLockingActor, UCameraComponent*& OutCamera);
+
+	//The controller that gets rotated towards the target
+	AController* GetLockController() const;
+
+	//AI controllers don't get their control rotation lerped, they focus the target instead
+	void SetAIFocus(bool bFocusTarget);
+
+	//Hands the rotation over to the camera modifier of the player camera manager, see FStruct_TargetLockData::RotateInCameraUpdate
+	void SetCameraModifierActive(bool bActive);
+
+	//Subscribes to the events that make a target invalid (destroyed, end play, untargetable tags, teleport),
+	//so the lock breaks right when they happen instead of being polled every tick
+	void BindTargetEvents();
+	void UnbindTargetEvents();
+
+	UFUNCTION()
+	void OnLockTargetDestroyed(AActor* DestroyedActor);
+
+	UFUNCTION()
+	void OnLockTargetEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+	void OnLockTargetTagChanged(const FGameplayTag Tag, int32 NewCount);
+
+	void OnLockTargetTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	FTargetLockTagEventBinding TargetTagEvents;
+	FDelegateHandle TargetTransformUpdatedHandle;
+
+	//The target the events are bound to, they have to be unbound from it even if CameraLockTarget changed
+	TWeakObjectPtr<AActor> BoundTarget;
 
 	//Lerps the rotation to rotate to locked target
 	void LerpTargetLocked(double DeltaTime);
 
-	//The camera that gets rotated towards the @CameraLockTarget
+	//Stops doing any work in TickTask until the target or the view moved enough or SleepCheckInterval passed.
+	//Only used while the target is inside the dead zone (AngleToStartLerp), see FStruct_TargetLockData::SleepInDeadZone.
+	void Sleep();
+
+	//Safe to call when not sleeping
+	void WakeUp();
+
+	void OnSleepTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	bool bSleeping = false;
+	float SleepTime = 0;
+
+	//Target and view at the moment the lock went to sleep
+	FVector SleepTargetLocation = FVector::ZeroVector;
+	FVector SleepViewLocation = FVector::ZeroVector;
+	FVector SleepViewForward = FVector::ForwardVector;
+
+	TWeakObjectPtr<USceneComponent> SleepTargetComponent;
+	TWeakObjectPtr<USceneComponent> SleepViewComponent;
+	FDelegateHandle SleepTargetTransformHandle;
+	FDelegateHandle SleepViewTransformHandle;
+
+	//Shows the visualize actor or indicator on the lock target, depending on the configured visualize mode
+	void AcquireVisualization();
+
+	//Hands the visualize actor back to the pool or removes the indicator. Safe to call multiple times.
+	void ReleaseVisualization();
+
+	//The camera that gets rotated towards the @CameraLockTarget. May be null for camera-less (AI) locks.
 	UPROPERTY(BlueprintReadOnly, meta=(ExposeOnSpawn="true"), Category = "GAS | Target Locking Task")
 	TObjectPtr<UCameraComponent> CameraComponent;
 
-	//The configuration for the task
+	//The actor that is locking on. Used for the view point when there is no camera and for Line of Sight checks.
+	UPROPERTY(BlueprintReadOnly, Category = "GAS | Target Locking Task")
+	TObjectPtr<AActor> LockingActor;
+
+	//The configuration for the task. Only used when no ConfigAsset is set.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GAS | Target Locking Task")
 	FStruct_TargetLockData Configuration;
 
+	//Shared configuration, takes priority over Configuration
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "GAS | Target Locking Task")
+	TObjectPtr<UTargetLockConfig> ConfigAsset;
+
 	//The target we want to keep in the center of the camera
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "GAS | Target Locking Task")
 	TObjectPtr<AActor> CameraLockTarget;
 
+	//Pooled actor visualizing the lock, owned by the UTargetLockSubsystem
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "Ability | Target Lock")
 	AActor* TargetLockVisualizeActor;
+
+	//Id of the instanced indicator drawn by the UTargetLockSubsystem, INDEX_NONE if there is none
+	int32 TargetLockIndicatorId = INDEX_NONE;
+
+	//Does the rotating while set, the task only keeps checking if the lock has to break
+	TWeakObjectPtr<UCameraModifier_TargetLock> CameraModifier;
+
+	//How long the target has been out of range, angle or sight. The lock breaks once this exceeds the grace time.
+	float LockBreakTimer = 0;
 	
 	/**
 	 * @return True if locking onto a target.
@@ -0,0 +1,298 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/GAS/Tasks/GASTask_TargetLockMulti.h"
+#include "TargetLockUtilities.h"
+#include "TargetLock/Data/TargetLockConfig.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "TargetLock/Debug/TargetLockDebugStats.h"
+#include "TargetLock/Visibility/TargetLockVisibilityProvider.h"
+#include "Abilities/GameplayAbility.h"
+#include "Camera/CameraComponent.h"
+#include "Engine/World.h"
+#include "WorldCollision.h"
+
+UGASTask_TargetLockMulti::UGASTask_TargetLockMulti(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	bTickingTask = true;
+}
+
+UGASTask_TargetLockMulti* UGASTask_TargetLockMulti::StartMultiTargetLock(UGameplayAbility* OwningAbility, FName TaskInstanceName,
+	UTargetLockConfig* Config, int32 MaxTargets, float AcquireInterval, AActor* OptionalOwningActor, UCameraComponent* OptionalCamera)
+{
+	if (!Config || MaxTargets <= 0) return nullptr;
+
+	AActor* OwningActor = OptionalOwningActor;
+	if (!OwningActor && OwningAbility)
+	{
+		OwningActor = OwningAbility->GetOwningActorFromActorInfo();
+	}
+	if (!OwningActor) return nullptr;
+
+	UGASTask_TargetLockMulti* MyObj = NewAbilityTask<UGASTask_TargetLockMulti>(OwningAbility, TaskInstanceName);
+
+	MyObj->ConfigAsset = Config;
+	MyObj->MaxTargets = MaxTargets;
+	MyObj->AcquireInterval = AcquireInterval;
+	MyObj->LockingActor = OwningActor;
+	MyObj->CameraComponent = OptionalCamera ? OptionalCamera : OwningActor->FindComponentByClass<UCameraComponent>();
+	return MyObj;
+}
+
+TArray<AActor*> UGASTask_TargetLockMulti::GetLockTargets() const
+{
+	TArray<AActor*> Result;
+	Result.Reserve(Targets.Num());
+	for (const FTargetLockPaintedTarget& Painted : Targets)
+	{
+		Result.Add(Painted.Target);
+	}
+	return Result;
+}
+
+void UGASTask_TargetLockMulti::Activate()
+{
+	Super::Activate();
+
+	if (!LockingActor || !ConfigAsset)
+	{
+		StopTask_Implementation();
+		return;
+	}
+
+	//Fill the slots right away instead of waiting for the first interval
+	AcquireTargets(UTargetLockUtilities::GetViewPoint(LockingActor, CameraComponent));
+}
+
+void UGASTask_TargetLockMulti::TickTask(float DeltaTime)
+{
+	Super::TickTask(DeltaTime);
+
+	if (!IsValid(LockingActor))
+	{
+		StopTask_Implementation();
+		return;
+	}
+
+	const FStruct_TargetLockData& Config = ConfigAsset->Data;
+	const FTargetLockViewPoint ViewPoint = UTargetLockUtilities::GetViewPoint(LockingActor, CameraComponent);
+
+	{
+		FTargetLockScopedDebugTimer DebugTimer(this, ETargetLockDebugTimer::Solve);
+
+		//Every target breaks on its own, Line of Sight uses the result of the last batch
+		for (int32 i = Targets.Num() - 1; i >= 0; i--)
+		{
+			FTargetLockPaintedTarget& Painted = Targets[i];
+			const AActor* Target = Painted.Target;
+			if (!IsValid(Target))
+			{
+				RemoveTargetAt(i);
+				continue;
+			}
+
+			const bool bStillLockable = UTargetLockUtilities::IsWithinBreakThresholds(Config, ViewPoint, Target->GetActorLocation()) &&
+				!UTargetLockUtilities::HasUntargetableTag(Config, Target) &&
+				(!Config.ContinuousLineOfSightCheck || Painted.bInSight);
+
+			if (UTargetLockUtilities::UpdateLockBreakTimer(Config, bStillLockable, DeltaTime, Painted.LockBreakTimer))
+			{
+				RemoveTargetAt(i);
+			}
+		}
+
+		if (Config.ContinuousLineOfSightCheck && Targets.Num() > 0)
+		{
+			IssueLineOfSightBatch(ViewPoint);
+		}
+	}
+
+	TimeSinceAcquire += DeltaTime;
+	if (Targets.Num() < MaxTargets && TimeSinceAcquire >= AcquireInterval)
+	{
+		TimeSinceAcquire = 0;
+		AcquireTargets(ViewPoint);
+	}
+}
+
+void UGASTask_TargetLockMulti::AcquireTargets(const FTargetLockViewPoint& ViewPoint)
+{
+	const int32 FreeSlots = MaxTargets - Targets.Num();
+	if (FreeSlots <= 0) return;
+
+	FTargetLockScopedDebugTimer DebugTimer(this, ETargetLockDebugTimer::Acquisition);
+
+	const FStruct_TargetLockData& Config = ConfigAsset->Data;
+
+	TArray<AActor*> Candidates;
+	UTargetLockUtilities::GatherCandidates(this, Config, LockingActor->GetActorLocation(), Config.MaxDistanceToStartTargetLock, Candidates);
+	if (Candidates.Num() == 0) return;
+
+	//The locked targets can't take a second slot
+	TArray<AActor*, TInlineAllocator<8>> Locked;
+	for (const FTargetLockPaintedTarget& Painted : Targets)
+	{
+		Locked.Add(Painted.Target);
+	}
+
+	TArray<AActor*> NewTargets;
+	UTargetLockUtilities::SelectBestTargets(this, Config, LockingActor, ViewPoint, Candidates, FreeSlots, NewTargets, false, nullptr, Locked);
+
+	for (AActor* Target : NewTargets)
+	{
+		AddTarget(Target);
+	}
+}
+
+void UGASTask_TargetLockMulti::IssueLineOfSightBatch(const FTargetLockViewPoint& ViewPoint)
+{
+	//The last batch is still in flight, its results are used until it's back
+	if (PendingLineOfSightTraces > 0) return;
+
+	UWorld* World = GetWorld();
+	if (!World) return;
+
+	const FStruct_TargetLockData& Config = ConfigAsset->Data;
+	const FTargetLockLineOfSightParams& TraceParams = Config.LineOfSightTrace;
+	FTargetLockDebugStats* Stats = FTargetLockDebugStats::Get(this);
+
+	const FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &UGASTask_TargetLockMulti::OnLineOfSightTraceDone);
+	LineOfSightBatch.Reset();
+
+	for (FTargetLockPaintedTarget& Painted : Targets)
+	{
+		AActor* Target = Painted.Target;
+		if (!Target) continue;
+
+		//Answers without a trace
+		if (Config.VisibilityProvider && Config.VisibilityProvider->IsConfirmedVisible(ViewPoint, LockingActor, Target))
+		{
+			Painted.bInSight = true;
+			if (Stats)
+			{
+				Stats->Current.SkippedTraces++;
+			}
+			continue;
+		}
+		if (Config.UseStaticVisibilityCache && UTargetLockUtilities::IsStaticallyBlocked(this, ViewPoint, nullptr, Target->GetActorLocation(), 0))
+		{
+			Painted.bInSight = false;
+			if (Stats)
+			{
+				Stats->Current.SkippedTraces++;
+			}
+			continue;
+		}
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TargetLockMultiLineOfSight), TraceParams.TraceComplex);
+		QueryParams.AddIgnoredActor(LockingActor);
+		QueryParams.AddIgnoredActor(Target);
+
+		const uint32 Slot = LineOfSightBatch.Add(Target);
+		if (!TraceParams.TraceProfile.IsNone())
+		{
+			World->AsyncLineTraceByProfile(EAsyncTraceType::Single, ViewPoint.Location, Target->GetActorLocation(), TraceParams.TraceProfile,
+				QueryParams, &TraceDelegate, Slot);
+		}
+		else
+		{
+			World->AsyncLineTraceByChannel(EAsyncTraceType::Single, ViewPoint.Location, Target->GetActorLocation(), TraceParams.TraceChannel,
+				QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, Slot);
+		}
+		PendingLineOfSightTraces++;
+	}
+}
+
+void UGASTask_TargetLockMulti::OnLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	PendingLineOfSightTraces = FMath::Max(0, PendingLineOfSightTraces - 1);
+
+	if (!LineOfSightBatch.IsValidIndex(TraceDatum.UserData)) return;
+	const AActor* Target = LineOfSightBatch[TraceDatum.UserData].Get();
+	if (!Target) return;
+
+	const bool bBlocked = TraceDatum.OutHits.Num() > 0 && TraceDatum.OutHits[0].bBlockingHit;
+	if (FTargetLockDebugStats* Stats = FTargetLockDebugStats::Get(this))
+	{
+		Stats->AddRay(TraceDatum.Start, TraceDatum.End, bBlocked);
+	}
+
+	//The target may have broken while the trace was in flight
+	FTargetLockPaintedTarget* Painted = Targets.FindByPredicate([Target](const FTargetLockPaintedTarget& Entry) { return Entry.Target == Target; });
+	if (Painted)
+	{
+		Painted->bInSight = !bBlocked;
+	}
+}
+
+void UGASTask_TargetLockMulti::AddTarget(AActor* Target)
+{
+	FTargetLockPaintedTarget& Painted = Targets.AddDefaulted_GetRef();
+	Painted.Target = Target;
+
+	UTargetLockSubsystem* Subsystem = GetWorld() ? GetWorld()->GetSubsystem<UTargetLockSubsystem>() : nullptr;
+	if (Subsystem)
+	{
+		const FStruct_TargetLockData& Config = ConfigAsset->Data;
+		switch (Config.VisualizeMode)
+		{
+		case ETargetLockVisualizeMode::Actor:
+			Painted.VisualizeActor = Subsystem->AcquireVisualizeActor(Config.TargetLockVisualizeActorClass, Target);
+			break;
+		case ETargetLockVisualizeMode::Instanced:
+			Painted.IndicatorId = Subsystem->AddLockIndicator(Config.TargetLockIndicatorMesh, Target,
+				Config.TargetLockIndicatorOffset, Config.TargetLockIndicatorScale);
+			break;
+		}
+	}
+
+	OnTargetLocked.Broadcast(Target);
+}
+
+void UGASTask_TargetLockMulti::RemoveTargetAt(int32 Index)
+{
+	AActor* Target = Targets[Index].Target;
+	ReleaseVisualization(Targets[Index]);
+	Targets.RemoveAt(Index);
+
+	OnTargetLost.Broadcast(Target);
+}
+
+void UGASTask_TargetLockMulti::ReleaseVisualization(FTargetLockPaintedTarget& Painted)
+{
+	if (!Painted.VisualizeActor && Painted.IndicatorId == INDEX_NONE) return;
+
+	if (UWorld* World = GetWorld())
+	{
+		if (UTargetLockSubsystem* Subsystem = World->GetSubsystem<UTargetLockSubsystem>())
+		{
+			Subsystem->ReleaseVisualizeActor(Painted.VisualizeActor);
+			Subsystem->RemoveLockIndicator(Painted.IndicatorId);
+		}
+	}
+	Painted.VisualizeActor = nullptr;
+	Painted.IndicatorId = INDEX_NONE;
+}
+
+void UGASTask_TargetLockMulti::OnDestroy(bool bInOwnerFinished)
+{
+	//Ended together with the ability, nobody is listening for OnTargetLost anymore
+	for (FTargetLockPaintedTarget& Painted : Targets)
+	{
+		ReleaseVisualization(Painted);
+	}
+	Targets.Reset();
+	LineOfSightBatch.Reset();
+	Super::OnDestroy(bInOwnerFinished);
+}
+
+void UGASTask_TargetLockMulti::StopTask_Implementation()
+{
+	for (int32 i = Targets.Num() - 1; i >= 0; i--)
+	{
+		RemoveTargetAt(i);
+	}
+	OnTaskEnded.Broadcast();
+	EndTask();
+}
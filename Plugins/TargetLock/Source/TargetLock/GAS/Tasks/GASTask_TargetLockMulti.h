@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GASTask_EndingAbilityTask.h"
+#include "TargetLock/Data/TargetLockData.h"
+#include "GASTask_TargetLockMulti.generated.h"
+
+class UCameraComponent;
+class UTargetLockConfig;
+struct FTraceHandle;
+struct FTraceDatum;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMultiTargetLockChanged, AActor*, Target);
+
+//A target held by a multi lock
+USTRUCT()
+struct TARGETLOCK_API FTargetLockPaintedTarget
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<AActor> Target;
+
+	//How long the target has been out of range, angle or sight, see UTargetLockUtilities::UpdateLockBreakTimer
+	float LockBreakTimer = 0;
+
+	//Result of the last Line of Sight batch
+	bool bInSight = true;
+
+	UPROPERTY()
+	TObjectPtr<AActor> VisualizeActor;
+
+	int32 IndicatorId = INDEX_NONE;
+};
+
+/**
+ * Keeps up to MaxTargets targets locked at once, e.g. to paint targets for a missile ability. The camera isn't rotated.
+ * Free slots get filled with the best candidates of one shared search, every target breaks on its own by the break rules of the config.
+ * The continuous Line of Sight checks of all targets go out together as one batch of async traces per tick.
+ * Runs until it gets stopped, even while no target is locked.
+ */
+UCLASS(Blueprintable, BlueprintType, Category = "GAS | Tasks")
+class TARGETLOCK_API UGASTask_TargetLockMulti : public UGASTask_EndingAbilityTask
+{
+	GENERATED_BODY()
+
+public:
+	UGASTask_TargetLockMulti(const FObjectInitializer& ObjectInitializer);
+
+	/**
+	 * Used to create a new Multi Target Lock Task. Should only be called from a Gameplay Ability
+	 *
+	 * @param OwningAbility The Ability that owns this task.
+	 * @param TaskInstanceName The name of the task, can be anything.
+	 * @param Config The shared configuration to use for acquiring and breaking. Required.
+	 * @param MaxTargets How many targets can be locked at once.
+	 * @param AcquireInterval How often free slots get searched for, in seconds.
+	 * @param OptionalOwningActor Optional: See UGASTask_TargetLock::StartTargetLock.
+	 * @param OptionalCamera Optional: The camera whose view the targets are searched in. See UGASTask_TargetLock::StartTargetLock.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Ability|Tasks", meta = (HidePin = "OwningAbility", DefaultToSelf = "OwningAbility", BlueprintInternalUseOnly = "True"))
+	static UGASTask_TargetLockMulti* StartMultiTargetLock(
+			UGameplayAbility* OwningAbility,
+			FName TaskInstanceName,
+			UTargetLockConfig* Config,
+			int32 MaxTargets = 4,
+			float AcquireInterval = 0.2f,
+			AActor* OptionalOwningActor = nullptr,
+			UCameraComponent* OptionalCamera = nullptr);
+
+	//The locked targets, in the order they were locked
+	UFUNCTION(BlueprintPure, Category = "GAS | Target Locking Task")
+	TArray<AActor*> GetLockTargets() const;
+
+	UPROPERTY(BlueprintAssignable)
+	FOnMultiTargetLockChanged OnTargetLocked;
+
+	//Fires for every target that broke or got dropped because the task stopped
+	UPROPERTY(BlueprintAssignable)
+	FOnMultiTargetLockChanged OnTargetLost;
+
+protected:
+	virtual void Activate() override;
+	virtual void TickTask(float DeltaTime) override;
+	virtual void OnDestroy(bool bInOwnerFinished) override;
+	virtual void StopTask_Implementation() override;
+
+	//Searches the free slots once, the candidates are gathered and scored together for all of them
+	void AcquireTargets(const FTargetLockViewPoint& ViewPoint);
+
+	//Sends one async trace per target that the visibility provider and the static visibility cache can't answer
+	void IssueLineOfSightBatch(const FTargetLockViewPoint& ViewPoint);
+
+	void OnLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	//Shows the visualize actor or indicator of the config on the new target and fires OnTargetLocked
+	void AddTarget(AActor* Target);
+
+	//Fires OnTargetLost
+	void RemoveTargetAt(int32 Index);
+
+	//Hands the visualize actor back to the pool or removes the indicator of the target
+	void ReleaseVisualization(FTargetLockPaintedTarget& Painted);
+
+	UPROPERTY(BlueprintReadOnly, Category = "GAS | Target Locking Task")
+	TObjectPtr<UCameraComponent> CameraComponent;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GAS | Target Locking Task")
+	TObjectPtr<AActor> LockingActor;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "GAS | Target Locking Task")
+	TObjectPtr<UTargetLockConfig> ConfigAsset;
+
+	UPROPERTY()
+	TArray<FTargetLockPaintedTarget> Targets;
+
+	int32 MaxTargets = 4;
+	float AcquireInterval = 0.2f;
+	float TimeSinceAcquire = 0;
+
+	//Targets of the Line of Sight batch in flight, indexed by the user data of the traces
+	TArray<TWeakObjectPtr<AActor>> LineOfSightBatch;
+	int32 PendingLineOfSightTraces = 0;
+};
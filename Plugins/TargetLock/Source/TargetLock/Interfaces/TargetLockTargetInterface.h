@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "TargetLockTargetInterface.generated.h"
+
+UINTERFACE(MinimalAPI, BlueprintType)
+class UTargetLockTargetInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Lets lock targets feed the weighted target scoring (see FTargetLockScoring) with gameplay information.
+ * Targets that don't implement this score 0 for threat and last damaged.
+ */
+class TARGETLOCK_API ITargetLockTargetInterface
+{
+	GENERATED_BODY()
+
+public:
+	//How dangerous this target is to the locker, 0..1
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Target Lock")
+	float GetTargetLockThreat(const AActor* Locker) const;
+
+	//Seconds since damage was last dealt between this target and the locker, in either direction. Negative if never.
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Target Lock")
+	float GetTargetLockTimeSinceDamaged(const AActor* Locker) const;
+};
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "TargetLockViewPointInterface.generated.h"
+
+UINTERFACE(MinimalAPI, BlueprintType)
+class UTargetLockViewPointInterface : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Lets actors without a camera tell the target lock where they look from.
+ * Actors that neither have a camera nor implement this use their eyes view point.
+ */
+class TARGETLOCK_API ITargetLockViewPointInterface
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @param OutLocation The location the actor looks from.
+	 * @param OutForward The normalized direction the actor looks at.
+	 */
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Target Lock")
+	void GetTargetLockViewPoint(FVector& OutLocation, FVector& OutForward) const;
+};
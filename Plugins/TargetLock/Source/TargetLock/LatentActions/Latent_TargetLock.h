@@ -51,8 +51,10 @@ class TARGETLOCK_API ULatent_TargetLock : public UBlueprintFunctionLibrary
 	 * @param DoLineOfSightCheck			If there should be an initial line of sight check to see if the target is behind a wall.
 	 * @param ContinuousLineOfSightCheck	If there should be a continuous line of sight check to see if the chosen target stays in sight. Will Cancel the action if target is behind walls.
 	 *
+	 * Deprecated: Triggers OnUpdated and with it the whole graph behind it every frame, see UAsyncAction_TargetLock.
 	 */
-	UFUNCTION(BlueprintCallable, meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="InputPins,OutputPins"), Category="Latent | TargetLock")
+	UFUNCTION(BlueprintCallable, meta=(WorldContext="WorldContext", Latent, LatentInfo="LatentInfo", ExpandEnumAsExecs="InputPins,OutputPins",
+		DeprecatedFunction, DeprecationMessage="Runs the graph behind OnUpdated every frame. Use Async Target Lock instead."), Category="Latent | TargetLock")
 	static void LatentTargetLock(UObject* WorldContext, FLatentActionInfo LatentInfo, ETargetLockInputPins InputPins, 
 		ETargetLockOutputPins& OutputPins, UCameraComponent* CameraComponent, TArray<TSubclassOf<AActor>> LockableClasses, AActor* LockTarget = nullptr, float MaxAngleToTarget = 40,
 		float AngleToStartLerp = 15, float RotateSpeed = 4, float HardRotateSpeedMultiplier = 10,
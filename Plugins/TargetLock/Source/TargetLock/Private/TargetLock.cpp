@@ -2,17 +2,41 @@
 
 #include "TargetLock.h"
 
+#if WITH_GAMEPLAY_DEBUGGER
+#include "GameplayDebugger.h"
+#include "TargetLock/Debug/GameplayDebuggerCategory_TargetLock.h"
+#endif
+
 #define LOCTEXT_NAMESPACE "FTargetLockModule"
 
 void FTargetLockModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+
+#if WITH_GAMEPLAY_DEBUGGER
+	if (IGameplayDebugger::IsAvailable())
+	{
+		IGameplayDebugger& GameplayDebuggerModule = IGameplayDebugger::Get();
+		GameplayDebuggerModule.RegisterCategory("TargetLock", IGameplayDebugger::FOnGetCategory::CreateStatic(&FGameplayDebuggerCategory_TargetLock::MakeInstance),
+			EGameplayDebuggerCategoryState::EnabledInGameAndSimulate);
+		GameplayDebuggerModule.NotifyCategoriesChanged();
+	}
+#endif
 }
 
 void FTargetLockModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+#if WITH_GAMEPLAY_DEBUGGER
+	if (IGameplayDebugger::IsAvailable())
+	{
+		IGameplayDebugger& GameplayDebuggerModule = IGameplayDebugger::Get();
+		GameplayDebuggerModule.UnregisterCategory("TargetLock");
+		GameplayDebuggerModule.NotifyCategoriesChanged();
+	}
+#endif
 }
 
 #undef LOCTEXT_NAMESPACE
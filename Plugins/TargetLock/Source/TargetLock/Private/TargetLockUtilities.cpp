@@ -2,7 +2,23 @@
 
 
 #include "TargetLockUtilities.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "TargetLock/Interfaces/TargetLockTargetInterface.h"
+#include "TargetLock/Interfaces/TargetLockViewPointInterface.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "TargetLock/Debug/TargetLockDebugStats.h"
+#include "TargetLock/Visibility/TargetLockVisibilityProvider.h"
+#include "Camera/CameraComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "Misc/App.h"
+#include "WorldCollision.h"
 
 //Heading Angle ignores Z, so I made this
 float UTargetLockUtilities::GetAngleToDirection(const FVector& Direction_A, const FVector& Direction_B)
@@ -55,7 +71,17 @@ bool UTargetLockUtilities::LineOfSightCheck(const UObject* WorldContext, const F
 	const FVector& TargetLocation, const FVector& RightVector, const FVector& UpVector, const FVector& ForwardVector,
 	const TArray<AActor*> IgnoreList, const float LoSDistance)
 {
-	if (!WorldContext) return false;
+	//Visibility channel against complex collision, what this always traced with
+	return LineOfSightCheckWithParams(WorldContext, OriginLocation, TargetLocation, RightVector, UpVector, ForwardVector,
+		IgnoreList, LoSDistance, FTargetLockLineOfSightParams());
+}
+
+bool UTargetLockUtilities::LineOfSightCheckWithParams(const UObject* WorldContext, const FVector& OriginLocation,
+	const FVector& TargetLocation, const FVector& RightVector, const FVector& UpVector, const FVector& ForwardVector,
+	const TArray<AActor*>& IgnoreList, const float LoSDistance, const FTargetLockLineOfSightParams& Params)
+{
+	const UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::LogAndReturnNull);
+	if (!World) return false;
 
 	const FVector RayCastTargetsEnemy[] {
 		TargetLocation,
@@ -77,16 +103,29 @@ bool UTargetLockUtilities::LineOfSightCheck(const UObject* WorldContext, const F
 		ForwardVector * -LoSDistance + OriginLocation
 	};
 
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TargetLockLineOfSight), Params.TraceComplex);
+	QueryParams.AddIgnoredActors(IgnoreList);
+
+	//Only whether something blocks matters, so test traces are enough
+	const bool bUseProfile = !Params.TraceProfile.IsNone();
+
+	FTargetLockDebugStats* Stats = FTargetLockDebugStats::Get(World);
+
 	int NonHits = 0;
 	for (FVector OriginLoc : RayCastTargetsOrigin)
 	{
 		for (FVector TargetLoc : RayCastTargetsEnemy)
 		{
-			FHitResult HitResult;
-			UKismetSystemLibrary::LineTraceSingle(WorldContext, OriginLoc, TargetLoc, TraceTypeQuery1, false,
-				IgnoreList, EDrawDebugTrace::None, HitResult, true);
+			const bool bBlocked = bUseProfile
+				? World->LineTraceTestByProfile(OriginLoc, TargetLoc, Params.TraceProfile, QueryParams)
+				: World->LineTraceTestByChannel(OriginLoc, TargetLoc, Params.TraceChannel, QueryParams);
 
-			if (!HitResult.bBlockingHit)
+			if (Stats)
+			{
+				Stats->AddRay(OriginLoc, TargetLoc, bBlocked);
+			}
+
+			if (!bBlocked)
 			{
 				NonHits++;
 				if (NonHits >= 2)
@@ -100,6 +139,32 @@ bool UTargetLockUtilities::LineOfSightCheck(const UObject* WorldContext, const F
 	return false;
 }
 
+bool UTargetLockUtilities::SweepLineOfSightCheck(const UObject* WorldContext, const FVector& OriginLocation,
+	const AActor* Target, const TArray<AActor*>& IgnoreList, const FTargetLockLineOfSightParams& Params)
+{
+	const UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::LogAndReturnNull);
+	const USceneComponent* TargetRoot = Target ? Target->GetRootComponent() : nullptr;
+	if (!World || !TargetRoot) return false;
+
+	const FBoxSphereBounds& Bounds = TargetRoot->Bounds;
+	const FCollisionShape Sphere = FCollisionShape::MakeSphere(FMath::Clamp(Bounds.SphereRadius * Params.SweepRadiusScale, 1.f, FMath::Max(Params.MaxSweepRadius, 1.f)));
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TargetLockLineOfSightSweep), Params.TraceComplex);
+	QueryParams.AddIgnoredActors(IgnoreList);
+	QueryParams.AddIgnoredActor(Target);
+
+	const bool bBlocked = !Params.TraceProfile.IsNone()
+		? World->SweepTestByProfile(OriginLocation, Bounds.Origin, FQuat::Identity, Params.TraceProfile, Sphere, QueryParams)
+		: World->SweepTestByChannel(OriginLocation, Bounds.Origin, FQuat::Identity, Params.TraceChannel, Sphere, QueryParams);
+
+	if (FTargetLockDebugStats* Stats = FTargetLockDebugStats::Get(World))
+	{
+		Stats->AddRay(OriginLocation, Bounds.Origin, bBlocked);
+	}
+
+	return !bBlocked;
+}
+
 float UTargetLockUtilities::FindRotationAddition(float RotationTarget, float RotationOrigin)
 {
 	if (RotationOrigin < 0 || RotationTarget < 0)
@@ -137,4 +202,569 @@ float UTargetLockUtilities::FindRotationAddition(float RotationTarget, float Rot
 			return (RotationTarget - RotationOrigin);
 		}
 	}
-}
\ No newline at end of file
+}
+
+FTargetLockViewPoint UTargetLockUtilities::GetViewPoint(const AActor* Owner, const USceneComponent* ViewComponent)
+{
+	FTargetLockViewPoint ViewPoint;
+	if (ViewComponent)
+	{
+		ViewPoint.Location = ViewComponent->GetComponentLocation();
+		ViewPoint.Forward = ViewComponent->GetForwardVector();
+
+		if (const UCameraComponent* Camera = Cast<UCameraComponent>(ViewComponent))
+		{
+			ViewPoint.FieldOfView = Camera->FieldOfView;
+			ViewPoint.AspectRatio = Camera->AspectRatio;
+		}
+	}
+	else if (Owner && Owner->Implements<UTargetLockViewPointInterface>())
+	{
+		ITargetLockViewPointInterface::Execute_GetTargetLockViewPoint(Owner, ViewPoint.Location, ViewPoint.Forward);
+		ViewPoint.Forward = ViewPoint.Forward.GetSafeNormal(UE_SMALL_NUMBER, FVector::ForwardVector);
+	}
+	else if (Owner)
+	{
+		FRotator EyesRotation;
+		Owner->GetActorEyesViewPoint(ViewPoint.Location, EyesRotation);
+		ViewPoint.Forward = EyesRotation.Vector();
+	}
+	return ViewPoint;
+}
+
+void UTargetLockUtilities::CullToViewFrustum(const FTargetLockViewPoint& ViewPoint, float Inset,
+	TArrayView<AActor* const> Candidates, TArray<AActor*>& OutVisible)
+{
+	const int32 Num = Candidates.Num();
+
+	TArray<FVector, TInlineAllocator<64>> Locations;
+	Locations.SetNumUninitialized(Num);
+	for (int32 i = 0; i < Num; i++)
+	{
+		//Missing candidates end up at the view point, which is never inside
+		Locations[i] = Candidates[i] ? Candidates[i]->GetActorLocation() : ViewPoint.Location;
+	}
+
+	TArray<bool, TInlineAllocator<64>> Inside;
+	Inside.SetNumUninitialized(Num);
+	TestViewFrustum(ViewPoint, Inset, Locations, Inside);
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		if (Inside[i])
+		{
+			OutVisible.Add(Candidates[i]);
+		}
+	}
+}
+
+void UTargetLockUtilities::TestViewFrustum(const FTargetLockViewPoint& ViewPoint, float Inset,
+	TArrayView<const FVector> Locations, TArrayView<bool> OutInside)
+{
+	check(Locations.Num() == OutInside.Num());
+
+	const int32 Num = Locations.Num();
+	const FRotationMatrix ViewMatrix(ViewPoint.Forward.Rotation());
+	const FVector3f Forward(ViewMatrix.GetScaledAxis(EAxis::X));
+	const FVector3f Right(ViewMatrix.GetScaledAxis(EAxis::Y));
+	const FVector3f Up(ViewMatrix.GetScaledAxis(EAxis::Z));
+
+	//View space coordinates, relative to the view point so floats are precise enough
+	TArray<float, TInlineAllocator<64>> Depths, Horizontals, Verticals;
+	Depths.SetNumUninitialized(Num);
+	Horizontals.SetNumUninitialized(Num);
+	Verticals.SetNumUninitialized(Num);
+	for (int32 i = 0; i < Num; i++)
+	{
+		const FVector3f Direction(Locations[i] - ViewPoint.Location);
+		Depths[i] = Direction | Forward;
+		Horizontals[i] = FMath::Abs(Direction | Right);
+		Verticals[i] = FMath::Abs(Direction | Up);
+	}
+
+	const float Scale = 1 - FMath::Clamp(Inset, 0.f, 0.9f);
+	const float TanHalfHorizontal = FMath::Tan(FMath::DegreesToRadians(ViewPoint.FieldOfView * 0.5f)) * Scale;
+	const float TanHalfVertical = FMath::Tan(FMath::DegreesToRadians(ViewPoint.FieldOfView * 0.5f)) / ViewPoint.AspectRatio * Scale;
+
+	for (int32 i = 0; i < Num; i++)
+	{
+		OutInside[i] = (Depths[i] > 0) & (Horizontals[i] <= Depths[i] * TanHalfHorizontal) & (Verticals[i] <= Depths[i] * TanHalfVertical);
+	}
+}
+
+AActor* UTargetLockUtilities::FindBestTarget(const UObject* WorldContext, const FStruct_TargetLockData& Config,
+	AActor* OwningActor, const USceneComponent* ViewComponent)
+{
+	if (!OwningActor) return nullptr;
+
+	return FindBestTargetFromViewPoint(WorldContext, Config, OwningActor, GetViewPoint(OwningActor, ViewComponent));
+}
+
+AActor* UTargetLockUtilities::FindBestTargetFromViewPoint(const UObject* WorldContext, const FStruct_TargetLockData& Config,
+	AActor* OwningActor, const FTargetLockViewPoint& ViewPoint)
+{
+	if (!WorldContext || !OwningActor) return nullptr;
+
+	FTargetLockScopedDebugTimer DebugTimer(WorldContext, ETargetLockDebugTimer::Acquisition);
+
+	TArray<AActor*> PossibleTargets{};
+	GatherCandidates(WorldContext, Config, OwningActor->GetActorLocation(), Config.MaxDistanceToStartTargetLock, PossibleTargets);
+
+	return SelectBestTarget(WorldContext, Config, OwningActor, ViewPoint, PossibleTargets);
+}
+
+void UTargetLockUtilities::GatherCandidates(const UObject* WorldContext, const FStruct_TargetLockData& Config,
+	const FVector& Origin, float Radius, TArray<AActor*>& OutCandidates)
+{
+	if (Config.LockableClasses.Num() == 0) return;
+
+	const UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::LogAndReturnNull);
+	if (!World) return;
+
+	if (Config.CandidateSource == ETargetLockCandidateSource::CandidateIndex)
+	{
+		if (UTargetLockSubsystem* Subsystem = World->GetSubsystem<UTargetLockSubsystem>())
+		{
+			Subsystem->GatherIndexedCandidates(Config, Origin, Radius, OutCandidates);
+			return;
+		}
+		//No subsystem in this world (e.g. editor preview), fall back to the overlap
+	}
+
+	if (Config.AcquisitionObjectTypes.Num() == 0) return;
+
+	//One overlap for all classes, the class filter is a lot cheaper than an overlap per class
+	const FCollisionObjectQueryParams ObjectParams(Config.AcquisitionObjectTypes);
+
+	TArray<FOverlapResult> Overlaps;
+	World->OverlapMultiByObjectType(Overlaps, Origin, FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(Radius),
+		FCollisionQueryParams(SCENE_QUERY_STAT(TargetLockAcquisition), false));
+
+	//Actors with multiple overlapping components show up multiple times
+	TSet<const AActor*> Seen;
+	Seen.Reserve(Overlaps.Num());
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		AActor* Actor = Overlap.GetActor();
+
+		bool bAlreadySeen = false;
+		Seen.Add(Actor, &bAlreadySeen);
+		if (bAlreadySeen || !IsLockableClass(Config, Actor)) continue;
+
+		OutCandidates.Add(Actor);
+	}
+}
+
+bool UTargetLockUtilities::IsLockableClass(const FStruct_TargetLockData& Config, const AActor* Actor)
+{
+	if (!Actor) return false;
+
+	for (const TSubclassOf<AActor>& LockClass : Config.LockableClasses)
+	{
+		if (LockClass && Actor->IsA(LockClass))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+AActor* UTargetLockUtilities::SelectBestTarget(const UObject* WorldContext, const FStruct_TargetLockData& Config,
+	AActor* OwningActor, const FTargetLockViewPoint& ViewPoint, TArrayView<AActor* const> Candidates, bool bFilterClasses,
+	const AActor* CurrentTarget)
+{
+	TArray<AActor*> Best;
+	SelectBestTargets(WorldContext, Config, OwningActor, ViewPoint, Candidates, 1, Best, bFilterClasses, CurrentTarget);
+	return Best.Num() > 0 ? Best[0] : nullptr;
+}
+
+void UTargetLockUtilities::SelectBestTargets(const UObject* WorldContext, const FStruct_TargetLockData& Config,
+	AActor* OwningActor, const FTargetLockViewPoint& ViewPoint, TArrayView<AActor* const> Candidates, int32 MaxTargets,
+	TArray<AActor*>& OutTargets, bool bFilterClasses, const AActor* CurrentTarget, TArrayView<AActor* const> Ignore)
+{
+	if (MaxTargets <= 0) return;
+
+	const FVector CameraLocation = ViewPoint.Location;
+	const FVector CameraForward = ViewPoint.Forward;
+
+	//The query id is resolved when the config gets loaded, the per target results are cached by the subsystem
+	UTargetLockSubsystem* Subsystem = nullptr;
+	int32 TagQueryId = INDEX_NONE;
+	if (!Config.TargetTagQuery.IsEmpty())
+	{
+		const UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull);
+		Subsystem = World ? World->GetSubsystem<UTargetLockSubsystem>() : nullptr;
+		TagQueryId = UTargetLockSubsystem::ResolveTargetTagQueryId(Config);
+	}
+
+	//Shared candidate lists (batched acquisition) contain the actors of every locker's classes, drop the other ones before any math
+	TArray<AActor*> LockableCandidates;
+	if (bFilterClasses)
+	{
+		LockableCandidates.Reserve(Candidates.Num());
+		for (AActor* Actor : Candidates)
+		{
+			if (Actor && IsLockableClass(Config, Actor))
+			{
+				LockableCandidates.Add(Actor);
+			}
+		}
+		Candidates = LockableCandidates;
+	}
+
+	//Cull against the actual view frustum before the per candidate checks, it replaces the angle check
+	const bool bFrustumCulled = Config.CullToViewFrustum && ViewPoint.HasFrustum();
+	TArray<AActor*> VisibleCandidates;
+	if (bFrustumCulled)
+	{
+		CullToViewFrustum(ViewPoint, Config.ViewFrustumInset, Candidates, VisibleCandidates);
+		Candidates = VisibleCandidates;
+	}
+
+	//Only the local player's own view gets rendered, for everybody else every candidate would look occluded
+	const UWorld* ContextWorld = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull);
+	const bool bUseRenderHint = Config.DoLineOfSightCheck && Config.SkipCandidatesNotRecentlyRendered &&
+		IsRenderedFromLockerView(OwningActor);
+
+	FTargetLockDebugStats* Stats = FTargetLockDebugStats::Get(ContextWorld);
+
+	//Cheap checks first. The criteria of the remaining candidates are stored per criterion, so every criterion
+	//can be scored for all candidates in one tight loop.
+	TArray<AActor*, TInlineAllocator<32>> Eligible;
+	TArray<float, TInlineAllocator<32>> DistanceAlphas;
+	TArray<float, TInlineAllocator<32>> AngleAlphas;
+	TArray<float, TInlineAllocator<32>> ThreatAlphas;
+	TArray<float, TInlineAllocator<32>> DamagedAlphas;
+	for (AActor* Actor : Candidates)
+	{
+		if (!Actor || Actor == OwningActor || Ignore.Contains(Actor)) continue;
+
+		//Rejections first, nothing gets scored for candidates that can't be locked anyway
+		if (HasUntargetableTag(Config, Actor)) continue;
+
+		if (!Config.TargetTagQuery.IsEmpty())
+		{
+			const bool bMatches = Subsystem ? Subsystem->MatchesTargetTagQuery(TagQueryId, Actor) : MatchesTargetTagQuery(Config, Actor);
+			if (!bMatches) continue;
+		}
+
+		float dist = FVector::Dist(CameraLocation, Actor->GetActorLocation());
+		if (dist > Config.MaxDistanceToStartTargetLock) continue;
+
+		FVector Direction = Actor->GetActorLocation() - CameraLocation;
+		float Angle = GetAngleToDirection(CameraForward, Direction);
+		if (!bFrustumCulled && Angle > Config.MaxAngleToTarget) continue;
+
+		//Free occlusion hint from the last frames, skips the traces for targets behind walls
+		if (bUseRenderHint && !Actor->WasRecentlyRendered())
+		{
+			if (Stats)
+			{
+				Stats->Current.SkippedTraces++;
+			}
+			continue;
+		}
+
+		Eligible.Add(Actor);
+		DistanceAlphas.Add(dist / FMath::Max(Config.MaxDistanceToStartTargetLock, 1.f));
+		AngleAlphas.Add(Angle / FMath::Max(Config.MaxAngleToTarget, 1.f));
+
+		if (!Config.UseWeightedScoring) continue;
+
+		float Threat = 0;
+		float Damaged = 0;
+		if (Actor->Implements<UTargetLockTargetInterface>())
+		{
+			Threat = ITargetLockTargetInterface::Execute_GetTargetLockThreat(Actor, OwningActor);
+
+			const float TimeSinceDamaged = ITargetLockTargetInterface::Execute_GetTargetLockTimeSinceDamaged(Actor, OwningActor);
+			if (TimeSinceDamaged >= 0 && Config.Scoring.LastDamagedWindow > 0)
+			{
+				Damaged = 1 - TimeSinceDamaged / Config.Scoring.LastDamagedWindow;
+			}
+		}
+		ThreatAlphas.Add(Threat);
+		DamagedAlphas.Add(Damaged);
+	}
+
+	if (Eligible.Num() == 0) return;
+
+	TArray<float, TInlineAllocator<32>> Scores;
+	Scores.SetNumZeroed(Eligible.Num());
+	if (Config.UseWeightedScoring)
+	{
+		const FTargetLockScoring& Scoring = Config.Scoring;
+		Scoring.Distance.AddScores(DistanceAlphas, Scores);
+		Scoring.Angle.AddScores(AngleAlphas, Scores);
+		Scoring.Threat.AddScores(ThreatAlphas, Scores);
+		Scoring.LastDamaged.AddScores(DamagedAlphas, Scores);
+
+		const int32 CurrentIndex = CurrentTarget ? Eligible.IndexOfByKey(CurrentTarget) : INDEX_NONE;
+		if (CurrentIndex != INDEX_NONE)
+		{
+			Scores[CurrentIndex] += Scoring.Stickiness;
+		}
+	}
+	else
+	{
+		//Closest wins
+		for (int32 i = 0; i < Scores.Num(); i++)
+		{
+			Scores[i] = -DistanceAlphas[i];
+		}
+	}
+
+	//Best first, so the expensive Line of Sight check only runs until enough candidates passed it
+	TArray<int32, TInlineAllocator<32>> Order;
+	Order.SetNumUninitialized(Eligible.Num());
+	for (int32 i = 0; i < Order.Num(); i++)
+	{
+		Order[i] = i;
+	}
+	Order.Sort([&Scores](const int32 A, const int32 B) { return Scores[A] > Scores[B]; });
+
+	if (Stats && Stats->FocusActor == OwningActor)
+	{
+		Stats->Candidates.Reset();
+		for (int32 i = 0; i < FMath::Min(Order.Num(), FTargetLockDebugStats::MaxCandidates); i++)
+		{
+			const int32 Index = Order[i];
+			const bool bWeighted = Config.UseWeightedScoring;
+			Stats->Candidates.Add({ Eligible[Index], DistanceAlphas[Index], AngleAlphas[Index],
+				bWeighted ? ThreatAlphas[Index] : 0.f, bWeighted ? DamagedAlphas[Index] : 0.f, Scores[Index] });
+		}
+	}
+
+	int32 Picked = 0;
+	for (const int32 Index : Order)
+	{
+		if (Config.DoLineOfSightCheck && !HasLineOfSightToTarget(WorldContext, Config, ViewPoint, OwningActor, Eligible[Index]))
+			continue;
+
+		OutTargets.Add(Eligible[Index]);
+		if (++Picked == MaxTargets) return;
+	}
+}
+
+bool UTargetLockUtilities::MatchesTargetTagQuery(const FStruct_TargetLockData& Config, const AActor* Target)
+{
+	if (Config.TargetTagQuery.IsEmpty()) return true;
+	if (!Target) return false;
+
+	if (const UWorld* World = Target->GetWorld())
+	{
+		if (UTargetLockSubsystem* Subsystem = World->GetSubsystem<UTargetLockSubsystem>())
+		{
+			const int32 TagQueryId = UTargetLockSubsystem::ResolveTargetTagQueryId(Config);
+			return Subsystem->MatchesTargetTagQuery(TagQueryId, Target);
+		}
+	}
+
+	FGameplayTagContainer OwnedTags;
+	if (const UAbilitySystemComponent* AbilitySystem = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Target))
+	{
+		AbilitySystem->GetOwnedGameplayTags(OwnedTags);
+	}
+	return Config.TargetTagQuery.Matches(OwnedTags);
+}
+
+bool UTargetLockUtilities::IsRenderedFromLockerView(const AActor* OwningActor)
+{
+	if (!OwningActor || !FApp::CanEverRender()) return false;
+
+	const UWorld* World = OwningActor->GetWorld();
+	if (!World || World->GetNetMode() == NM_DedicatedServer) return false;
+
+	const APawn* Pawn = Cast<APawn>(OwningActor);
+	return Pawn && Pawn->IsLocallyControlled() && Pawn->IsPlayerControlled();
+}
+
+bool UTargetLockUtilities::HasUntargetableTag(const FStruct_TargetLockData& Config, const AActor* Target)
+{
+	if (Config.UntargetableTags.IsEmpty()) return false;
+
+	const UAbilitySystemComponent* AbilitySystem = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Target);
+	return AbilitySystem && AbilitySystem->HasAnyMatchingGameplayTags(Config.UntargetableTags);
+}
+
+AController* UTargetLockUtilities::GetLockController(const AActor* Locker)
+{
+	if (!Locker) return nullptr;
+
+	if (const APawn* Pawn = Cast<APawn>(Locker))
+	{
+		return Pawn->GetController();
+	}
+	if (const APlayerState* PlayerState = Cast<APlayerState>(Locker))
+	{
+		return PlayerState->GetOwningController();
+	}
+	if (AController* Controller = const_cast<AController*>(Cast<AController>(Locker)))
+	{
+		return Controller;
+	}
+	return Locker->GetInstigatorController();
+}
+
+bool UTargetLockUtilities::HasLineOfSightToTarget(const UObject* WorldContext, const FStruct_TargetLockData& Config,
+	const FTargetLockViewPoint& ViewPoint, AActor* OwningActor, AActor* Target)
+{
+	if (!WorldContext || !Target) return false;
+
+	if (Config.VisibilityProvider && Config.VisibilityProvider->IsConfirmedVisible(ViewPoint, OwningActor, Target))
+	{
+		if (FTargetLockDebugStats* Stats = FTargetLockDebugStats::Get(WorldContext))
+		{
+			Stats->Current.SkippedTraces++;
+		}
+		return true;
+	}
+
+	//Every ray of the pattern starts and ends within 75 of the view point or owner and the target, see below
+	if (Config.UseStaticVisibilityCache && IsStaticallyBlocked(WorldContext, ViewPoint, OwningActor, Target->GetActorLocation(), 75))
+	{
+		if (FTargetLockDebugStats* Stats = FTargetLockDebugStats::Get(WorldContext))
+		{
+			Stats->Current.SkippedTraces++;
+		}
+		return false;
+	}
+
+	const TArray<AActor*> IgnoreList{ OwningActor, Target };
+
+	//Most targets in sight are found by the single sweep, the ray pattern is only needed for partially covered ones
+	if (Config.LineOfSightTrace.Mode == ETargetLockLineOfSightMode::Sweep &&
+		SweepLineOfSightCheck(WorldContext, ViewPoint.Location, Target, IgnoreList, Config.LineOfSightTrace))
+	{
+		return true;
+	}
+
+	const FRotationMatrix ViewMatrix(ViewPoint.Forward.Rotation());
+
+	if (LineOfSightCheckWithParams(WorldContext, ViewPoint.Location, Target->GetActorLocation(),
+			ViewMatrix.GetScaledAxis(EAxis::Y), ViewMatrix.GetScaledAxis(EAxis::Z), ViewPoint.Forward, IgnoreList, 75, Config.LineOfSightTrace))
+	{
+		return true;
+	}
+
+	return OwningActor && LineOfSightCheckWithParams(WorldContext, OwningActor->GetActorLocation(), Target->GetActorLocation(),
+		OwningActor->GetActorRightVector(), OwningActor->GetActorUpVector(), OwningActor->GetActorForwardVector(), IgnoreList, 75, Config.LineOfSightTrace);
+}
+
+bool UTargetLockUtilities::IsStaticallyBlocked(const UObject* WorldContext, const FTargetLockViewPoint& ViewPoint,
+	const AActor* OwningActor, const FVector& TargetLocation, float Margin)
+{
+	const UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::ReturnNull);
+	const UTargetLockSubsystem* Subsystem = World ? World->GetSubsystem<UTargetLockSubsystem>() : nullptr;
+	if (!Subsystem) return false;
+
+	//The traces also run from the owner's location, both have to be blocked
+	return Subsystem->IsStaticallyBlocked(ViewPoint.Location, TargetLocation, Margin) &&
+		(!OwningActor || Subsystem->IsStaticallyBlocked(OwningActor->GetActorLocation(), TargetLocation, Margin));
+}
+
+bool UTargetLockUtilities::IsTargetStillLockable(const UObject* WorldContext, const FStruct_TargetLockData& Config,
+	AActor* OwningActor, const FTargetLockViewPoint& ViewPoint, AActor* Target)
+{
+	if (!IsValid(Target)) return false;
+
+	if (!IsWithinBreakThresholds(Config, ViewPoint, Target->GetActorLocation())) return false;
+
+	return !Config.ContinuousLineOfSightCheck || HasLineOfSightToTarget(WorldContext, Config, ViewPoint, OwningActor, Target);
+}
+
+bool UTargetLockUtilities::IsWithinBreakThresholds(const FStruct_TargetLockData& Config, const FTargetLockViewPoint& ViewPoint,
+	const FVector& TargetLocation)
+{
+	const FVector Direction = TargetLocation - ViewPoint.Location;
+	if (Direction.Size() > Config.GetBreakDistance()) return false;
+
+	return Config.MaxAngleToKeepTargetLock <= 0 || GetAngleToDirection(ViewPoint.Forward, Direction) <= Config.MaxAngleToKeepTargetLock;
+}
+
+bool UTargetLockUtilities::HasLineOfSightToLocation(const UObject* WorldContext, const FStruct_TargetLockData& Config,
+	const FTargetLockViewPoint& ViewPoint, AActor* OwningActor, const FVector& TargetLocation)
+{
+	if (Config.UseStaticVisibilityCache && IsStaticallyBlocked(WorldContext, ViewPoint, nullptr, TargetLocation, 75))
+	{
+		if (FTargetLockDebugStats* Stats = FTargetLockDebugStats::Get(WorldContext))
+		{
+			Stats->Current.SkippedTraces++;
+		}
+		return false;
+	}
+
+	const TArray<AActor*> IgnoreList{ OwningActor };
+	const FRotationMatrix ViewMatrix(ViewPoint.Forward.Rotation());
+
+	return LineOfSightCheckWithParams(WorldContext, ViewPoint.Location, TargetLocation, ViewMatrix.GetScaledAxis(EAxis::Y),
+		ViewMatrix.GetScaledAxis(EAxis::Z), ViewPoint.Forward, IgnoreList, 75, Config.LineOfSightTrace);
+}
+
+bool UTargetLockUtilities::UpdateLockBreakTimer(const FStruct_TargetLockData& Config, bool bStillLockable, float DeltaTime, float& InOutBreakTimer)
+{
+	if (bStillLockable)
+	{
+		InOutBreakTimer = 0;
+		return false;
+	}
+
+	InOutBreakTimer += DeltaTime;
+	return InOutBreakTimer >= Config.LockBreakGraceTime;
+}
+
+FRotator UTargetLockUtilities::ComputeLockRotationDelta(const FStruct_TargetLockData& Config, const FVector& ViewLocation,
+	const FVector& ViewForward, const FVector& TargetLocation, const FRotator& ControlRotation, float DeltaTime, float& OutAngle)
+{
+	//Setup Calculation Data
+	const FVector CameraDirection = ViewForward * FVector::Dist(ViewLocation, TargetLocation);
+	const FVector TargetDirection = TargetLocation - ViewLocation;
+
+	//this vector is perpendicular to TargetLocation
+	const FVector ProjectedVector = UKismetMathLibrary::ProjectVectorOnToVector(TargetDirection, CameraDirection);
+
+	OutAngle = GetAngleToDirection(TargetDirection, CameraDirection);
+
+	//We don't need any additional rotation
+	if (OutAngle < Config.AngleToStartLerp)
+	{
+		return FRotator::ZeroRotator;
+	}
+
+	//Create a Look At Target based on the projected vector to rotate camera towards
+	FVector NormalizedAngledDirection = TargetLocation - (ProjectedVector + ViewLocation);
+	NormalizedAngledDirection.Normalize();
+
+	const FVector SoftRotationLookAtTarget = (NormalizedAngledDirection * (asin((OutAngle - Config.AngleToStartLerp) * (PI / 180)) * TargetDirection.Length()));
+	const FVector HardRotationLookAtTarget = (NormalizedAngledDirection * (asin((OutAngle - Config.MaxAngleToTarget) * (PI / 180)) * TargetDirection.Length()));
+
+	//These are the desired points based on our rotation to the target.
+	const FRotator TargetSoftRotator = UKismetMathLibrary::FindLookAtRotation(ViewLocation, ViewLocation + ProjectedVector + SoftRotationLookAtTarget);
+	const FRotator TargetHardRotator = UKismetMathLibrary::FindLookAtRotation(ViewLocation, ViewLocation + ProjectedVector + HardRotationLookAtTarget);
+
+	FRotator Rotation = ControlRotation;
+
+	//Do the hard rotation, if needed based on our look at angle to the target
+	if (OutAngle >= Config.MaxAngleToTarget)
+	{
+		float CalcYaw = FindRotationAddition(TargetHardRotator.Yaw, Rotation.Yaw);
+		CalcYaw *= DeltaTime * Config.HardRotateSpeedMultiplier;
+
+		float CalcPitch = FindRotationAddition(TargetHardRotator.Pitch, Rotation.Pitch);
+		CalcPitch *= DeltaTime * Config.HardRotateSpeedMultiplier;
+
+		Rotation += FRotator(CalcPitch, CalcYaw, 0);
+	}
+
+	//Do the smooth rotation towards the target, on top of the hard rotation
+	float CalcYaw = FindRotationAddition(TargetSoftRotator.Yaw, Rotation.Yaw);
+	CalcYaw *= Config.RotateSpeed * DeltaTime;
+
+	float CalcPitch = FindRotationAddition(TargetSoftRotator.Pitch, Rotation.Pitch);
+	CalcPitch *= Config.RotateSpeed * DeltaTime;
+
+	Rotation += FRotator(CalcPitch, CalcYaw, 0);
+
+	return Rotation - ControlRotation;
+}
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "TargetLock/Data/TargetLockData.h"
 #include "TargetLockUtilities.generated.h"
 
 /**
@@ -35,7 +36,152 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContext"), Category = "Line Trace | Line of Sight")
 	static bool LineOfSightCheck(const UObject* WorldContext, const FVector& OriginLocation, const FVector& TargetLocation, const FVector& RightVector, const FVector& UpVector, const FVector& ForwardVector, const TArray<AActor*> IgnoreList, const float LoSDistance);
 
+	//Same as LineOfSightCheck, but traces with the given channel / profile and complexity instead of the Visibility channel against complex collision
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContext"), Category = "Line Trace | Line of Sight")
+	static bool LineOfSightCheckWithParams(const UObject* WorldContext, const FVector& OriginLocation, const FVector& TargetLocation, const FVector& RightVector, const FVector& UpVector, const FVector& ForwardVector, const TArray<AActor*>& IgnoreList, const float LoSDistance, const FTargetLockLineOfSightParams& Params);
+
+	/**
+	 * Line of Sight check with a single sphere sweep from the origin to the center of the target's root component bounds.
+	 * The sweep radius scales with the size of the target (see FTargetLockLineOfSightParams::SweepRadiusScale).
+	 *
+	 * @return True if the sweep got through. False does not mean the target is hidden, only that the sweep got blocked.
+	 */
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContext"), Category = "Line Trace | Line of Sight")
+	static bool SweepLineOfSightCheck(const UObject* WorldContext, const FVector& OriginLocation, const AActor* Target, const TArray<AActor*>& IgnoreList, const FTargetLockLineOfSightParams& Params);
+
 	//Finds the amount of rotation to add to reach the desired rotation by checking which way is the shortest.
 	UFUNCTION(BlueprintPure, Category="Rotation")
 	static float FindRotationAddition(float RotationTarget, float RotationOrigin);
+
+	/**
+	 * Where the owner looks from. Uses the view component if given, otherwise ITargetLockViewPointInterface
+	 * and as last resort the eyes view point of the owner, so lockers without a camera (AI) work as well.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Target Lock")
+	static FTargetLockViewPoint GetViewPoint(const AActor* Owner, const USceneComponent* ViewComponent = nullptr);
+
+	/**
+	 * Searches for the closest actor of one of the lockable classes that is in range and inside the view angle.
+	 * Does the initial Line of Sight check if the configuration asks for it.
+	 *
+	 * @param WorldContext Object to get the world from.
+	 * @param Config The lock configuration to search with.
+	 * @param OwningActor The actor locking on, the overlap is centered on it and it is ignored by the Line of Sight Check.
+	 * @param ViewComponent Optional: The component looking for a target, usually the camera. See GetViewPoint if not given.
+	 * @return The best target or nullptr if none was found.
+	 */
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContext"), Category = "Target Lock")
+	static AActor* FindBestTarget(const UObject* WorldContext, const FStruct_TargetLockData& Config, AActor* OwningActor, const USceneComponent* ViewComponent = nullptr);
+
+	//Same as FindBestTarget but searches from an explicit view point
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContext"), Category = "Target Lock")
+	static AActor* FindBestTargetFromViewPoint(const UObject* WorldContext, const FStruct_TargetLockData& Config, AActor* OwningActor, const FTargetLockViewPoint& ViewPoint);
+
+	/**
+	 * Keeps the candidates inside the view frustum of the view point. Transforms all candidates into view space
+	 * first and tests them against the frustum planes in a second, branch free pass.
+	 *
+	 * @param Inset Shrinks the frustum on every side, 0..1 of its half size.
+	 */
+	static void CullToViewFrustum(const FTargetLockViewPoint& ViewPoint, float Inset, TArrayView<AActor* const> Candidates, TArray<AActor*>& OutVisible);
+
+	//The math of CullToViewFrustum on plain locations, one result per location. Doesn't touch any UObject, safe on worker threads.
+	static void TestViewFrustum(const FTargetLockViewPoint& ViewPoint, float Inset, TArrayView<const FVector> Locations, TArrayView<bool> OutInside);
+
+	//Appends the actors around the origin that are of one of the lockable classes of the config.
+	//Either overlaps one sphere with the acquisition object types or asks the candidate index, depending on the config.
+	static void GatherCandidates(const UObject* WorldContext, const FStruct_TargetLockData& Config, const FVector& Origin, float Radius, TArray<AActor*>& OutCandidates);
+
+	//True if the actor is of one of the lockable classes of the config
+	static bool IsLockableClass(const FStruct_TargetLockData& Config, const AActor* Actor);
+
+	/**
+	 * Picks the best candidate that is in range, inside the view angle and, if the config asks for it, in line of sight.
+	 * Best is the closest one, or the one with the highest score if the config uses weighted scoring.
+	 * Line of Sight is only checked for the candidates in order of their score until one passes.
+	 *
+	 * @param bFilterClasses Skip candidates that are not of a lockable class. Required if the candidates were not gathered for this config.
+	 * @param CurrentTarget Optional: The target the owner currently has, it gets the stickiness bonus of the weighted scoring.
+	 */
+	static AActor* SelectBestTarget(const UObject* WorldContext, const FStruct_TargetLockData& Config, AActor* OwningActor,
+		const FTargetLockViewPoint& ViewPoint, TArrayView<AActor* const> Candidates, bool bFilterClasses = false, const AActor* CurrentTarget = nullptr);
+
+	/**
+	 * SelectBestTarget for several targets at once, e.g. for multi locks. Candidates get filtered and scored once,
+	 * Line of Sight is checked in order of their score until enough of them passed.
+	 *
+	 * @param MaxTargets How many targets to pick at most.
+	 * @param OutTargets The picked targets, best first. Appended to.
+	 * @param Ignore Candidates that must not be picked, e.g. the targets a multi lock already has.
+	 */
+	static void SelectBestTargets(const UObject* WorldContext, const FStruct_TargetLockData& Config, AActor* OwningActor,
+		const FTargetLockViewPoint& ViewPoint, TArrayView<AActor* const> Candidates, int32 MaxTargets, TArray<AActor*>& OutTargets,
+		bool bFilterClasses = false, const AActor* CurrentTarget = nullptr, TArrayView<AActor* const> Ignore = TArrayView<AActor* const>());
+
+	/**
+	 * True if the owned tags of the target match the TargetTagQuery of the config. Always true for an empty query.
+	 * Goes through the tag query cache of the UTargetLockSubsystem when there is one, so repeated checks of the same
+	 * target are only evaluated again after its tags changed.
+	 */
+	UFUNCTION(BlueprintPure, Category = "Target Lock")
+	static bool MatchesTargetTagQuery(const FStruct_TargetLockData& Config, const AActor* Target);
+
+	//True if the target owns one of the UntargetableTags of the config
+	UFUNCTION(BlueprintPure, Category = "Target Lock")
+	static bool HasUntargetableTag(const FStruct_TargetLockData& Config, const AActor* Target);
+
+	//True if what this machine renders is the view of the locker: a pawn of a local player in a world that renders.
+	//Render times say nothing about what AI, remote players or anything on a dedicated server can see.
+	static bool IsRenderedFromLockerView(const AActor* OwningActor);
+
+	//The controller whose rotation a lock of the given actor drives. Handles pawns, controllers and player states.
+	UFUNCTION(BlueprintPure, Category = "Target Lock")
+	static AController* GetLockController(const AActor* Locker);
+
+	//The Line of Sight check of the target lock. Checks from the view point and from the owner, either one is enough.
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContext"), Category = "Target Lock")
+	static bool HasLineOfSightToTarget(const UObject* WorldContext, const FStruct_TargetLockData& Config, const FTargetLockViewPoint& ViewPoint, AActor* OwningActor, AActor* Target);
+
+	//True if a baked ATargetLockVisibilityVolume knows that static geometry hides the target location from the view point and the owner
+	static bool IsStaticallyBlocked(const UObject* WorldContext, const FTargetLockViewPoint& ViewPoint, const AActor* OwningActor, const FVector& TargetLocation, float Margin);
+
+	//True if the target is still within the break distance and angle and, if the configuration asks for it, in line of sight.
+	//These thresholds are looser than the ones to acquire a target, so locks don't flicker at the edges.
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContext"), Category = "Target Lock")
+	static bool IsTargetStillLockable(const UObject* WorldContext, const FStruct_TargetLockData& Config, AActor* OwningActor, const FTargetLockViewPoint& ViewPoint, AActor* Target);
+
+	//True if a target at the location is still within the break distance and angle of the config
+	static bool IsWithinBreakThresholds(const FStruct_TargetLockData& Config, const FTargetLockViewPoint& ViewPoint, const FVector& TargetLocation);
+
+	//Line of Sight check towards a location instead of an actor, for targets without one (see ITargetLockEntitySource)
+	UFUNCTION(BlueprintCallable, meta = (WorldContext = "WorldContext"), Category = "Target Lock")
+	static bool HasLineOfSightToLocation(const UObject* WorldContext, const FStruct_TargetLockData& Config, const FTargetLockViewPoint& ViewPoint, AActor* OwningActor, const FVector& TargetLocation);
+
+	/**
+	 * Runs the grace timer of a lock. Call once per lock update.
+	 *
+	 * @param Config The lock configuration.
+	 * @param bStillLockable Result of IsTargetStillLockable for this update.
+	 * @param DeltaTime Time since the last update.
+	 * @param InOutBreakTimer How long the target has not been lockable, reset when it is lockable again.
+	 * @return True if the lock has to break.
+	 */
+	static bool UpdateLockBreakTimer(const FStruct_TargetLockData& Config, bool bStillLockable, float DeltaTime, float& InOutBreakTimer);
+
+	/**
+	 * Calculates how much the control rotation has to change this frame to keep the target in view.
+	 * The hard rotation kicks in beyond MaxAngleToTarget, the smooth one beyond AngleToStartLerp.
+	 * Both are combined into one rotation so it only has to be applied once.
+	 *
+	 * @param Config The lock configuration.
+	 * @param ViewLocation Location of the camera / eyes.
+	 * @param ViewForward Forward vector of the camera / eyes.
+	 * @param TargetLocation Location of the lock target.
+	 * @param ControlRotation The current control rotation.
+	 * @param DeltaTime Frame time.
+	 * @param OutAngle Angle between view direction and target in degrees.
+	 * @return Rotation to add to the control rotation. Zero if the target is inside AngleToStartLerp.
+	 */
+	static FRotator ComputeLockRotationDelta(const FStruct_TargetLockData& Config, const FVector& ViewLocation, const FVector& ViewForward,
+		const FVector& TargetLocation, const FRotator& ControlRotation, float DeltaTime, float& OutAngle);
 };
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Subsystems/TargetLockAsyncAcquisition.h"
+#include "TargetLockUtilities.h"
+
+void FTargetLockAsyncAcquisition::Score()
+{
+	//Unbaked curves would be read from this worker thread
+	check(!bUseWeightedScoring || Scoring.IsBaked());
+
+	const int32 Num = Locations.Num();
+	Order.Reset();
+
+	TArray<bool, TInlineAllocator<64>> Inside;
+	Inside.SetNumUninitialized(Num);
+	const bool bFrustumCulled = bCullToViewFrustum && ViewPoint.HasFrustum();
+	if (bFrustumCulled)
+	{
+		UTargetLockUtilities::TestViewFrustum(ViewPoint, ViewFrustumInset, Locations, Inside);
+	}
+
+	TArray<int32, TInlineAllocator<64>> Eligible;
+	TArray<float, TInlineAllocator<64>> DistanceAlphas;
+	TArray<float, TInlineAllocator<64>> AngleAlphas;
+	TArray<float, TInlineAllocator<64>> ThreatAlphas;
+	TArray<float, TInlineAllocator<64>> Damaged;
+	for (int32 i = 0; i < Num; i++)
+	{
+		if (bFrustumCulled && !Inside[i]) continue;
+
+		const FVector Direction = Locations[i] - ViewPoint.Location;
+		const float Distance = Direction.Size();
+		if (Distance > MaxDistance) continue;
+
+		const float Angle = UTargetLockUtilities::GetAngleToDirection(ViewPoint.Forward, Direction);
+		if (!bFrustumCulled && Angle > MaxAngle) continue;
+
+		Eligible.Add(i);
+		DistanceAlphas.Add(Distance / FMath::Max(MaxDistance, 1.f));
+		AngleAlphas.Add(Angle / FMath::Max(MaxAngle, 1.f));
+		ThreatAlphas.Add(Threats[i]);
+		Damaged.Add(DamagedAlphas[i]);
+	}
+
+	TArray<float, TInlineAllocator<64>> Scores;
+	Scores.SetNumZeroed(Eligible.Num());
+	if (bUseWeightedScoring)
+	{
+		Scoring.Distance.AddScores(DistanceAlphas, Scores);
+		Scoring.Angle.AddScores(AngleAlphas, Scores);
+		Scoring.Threat.AddScores(ThreatAlphas, Scores);
+		Scoring.LastDamaged.AddScores(Damaged, Scores);
+
+		const int32 Current = Eligible.IndexOfByKey(CurrentIndex);
+		if (CurrentIndex != INDEX_NONE && Current != INDEX_NONE)
+		{
+			Scores[Current] += Scoring.Stickiness;
+		}
+	}
+	else
+	{
+		//Closest wins
+		for (int32 i = 0; i < Scores.Num(); i++)
+		{
+			Scores[i] = -DistanceAlphas[i];
+		}
+	}
+
+	TArray<int32, TInlineAllocator<64>> Sorted;
+	Sorted.SetNumUninitialized(Eligible.Num());
+	for (int32 i = 0; i < Sorted.Num(); i++)
+	{
+		Sorted[i] = i;
+	}
+	Sorted.Sort([&Scores](const int32 A, const int32 B) { return Scores[A] > Scores[B]; });
+
+	Order.Reserve(Sorted.Num());
+	for (const int32 Index : Sorted)
+	{
+		Order.Add(Eligible[Index]);
+	}
+}
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+#include "TargetLock/Data/TargetLockData.h"
+
+class UTargetLockConfig;
+
+/**
+ * A target search of one locker that gets filtered and scored on a worker thread.
+ * Everything that needs a UObject (gathering candidates, tags, the target interface) is done on the game thread while
+ * the snapshot is built, Score only works on the copied values.
+ */
+struct TARGETLOCK_API FTargetLockAsyncAcquisition
+{
+	TObjectKey<AActor> Owner;
+	FTargetLockViewPoint ViewPoint;
+
+	//Only used on the game thread, for the Line of Sight checks once the worker is done
+	TWeakObjectPtr<const UTargetLockConfig> Config;
+
+	//Copied out of the config, the config asset may change while the worker runs
+	float MaxDistance = 0;
+	float MaxAngle = 0;
+	bool bCullToViewFrustum = false;
+	float ViewFrustumInset = 0;
+	bool bUseWeightedScoring = false;
+	FTargetLockScoring Scoring;
+
+	//Snapshot of the candidates that passed the game thread checks, parallel arrays.
+	//The weak pointers are only carried along and never resolved on the worker.
+	TArray<TWeakObjectPtr<AActor>> Candidates;
+	TArray<FVector> Locations;
+	TArray<float> Threats;
+	TArray<float> DamagedAlphas;
+
+	//Index of the current target of the locker in Candidates, INDEX_NONE if it has none
+	int32 CurrentIndex = INDEX_NONE;
+
+	//Result: indices into Candidates of the candidates in range and view, best first
+	TArray<int32> Order;
+
+	//Worker thread part. Does the same filtering and scoring as UTargetLockUtilities::SelectBestTarget.
+	void Score();
+};
+
+//A batch of searches handed to one worker task
+using FTargetLockAsyncAcquisitionBatch = TArray<FTargetLockAsyncAcquisition>;
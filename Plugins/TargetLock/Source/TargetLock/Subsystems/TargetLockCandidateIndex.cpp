@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Subsystems/TargetLockCandidateIndex.h"
+#include "Engine/Level.h"
+#include "GameFramework/Actor.h"
+
+FTargetLockCandidateIndex::FTargetLockCandidateIndex(double InCellSize)
+	: CellSize(FMath::Max(InCellSize, 100.0))
+{
+}
+
+void FTargetLockCandidateIndex::Add(AActor* Actor)
+{
+	if (!Actor || Lookup.Contains(Actor)) return;
+
+	Lookup.Add(Actor, Actors.Add(Actor));
+	Keys.Add(Actor);
+	SortedIndices.Add(INDEX_NONE);
+}
+
+void FTargetLockCandidateIndex::Remove(const AActor* Actor)
+{
+	if (const int32* Index = Lookup.Find(Actor))
+	{
+		RemoveAt(*Index);
+	}
+}
+
+void FTargetLockCandidateIndex::RemoveAt(int32 Index)
+{
+	//Queries until the next Rebuild must not return it anymore
+	if (SortedIndices[Index] != INDEX_NONE)
+	{
+		SortedActors[SortedIndices[Index]].Reset();
+	}
+
+	Lookup.Remove(Keys[Index]);
+	Actors.RemoveAtSwap(Index, 1, false);
+	Keys.RemoveAtSwap(Index, 1, false);
+	SortedIndices.RemoveAtSwap(Index, 1, false);
+	if (Keys.IsValidIndex(Index))
+	{
+		Lookup.Add(Keys[Index], Index);
+	}
+}
+
+void FTargetLockCandidateIndex::AddLevel(const ULevel* Level, TFunctionRef<bool(const AActor*)> Filter)
+{
+	if (!Level) return;
+
+	Actors.Reserve(Actors.Num() + Level->Actors.Num());
+	Keys.Reserve(Keys.Num() + Level->Actors.Num());
+	SortedIndices.Reserve(SortedIndices.Num() + Level->Actors.Num());
+	for (AActor* Actor : Level->Actors)
+	{
+		if (IsValid(Actor) && Filter(Actor))
+		{
+			Add(Actor);
+		}
+	}
+}
+
+void FTargetLockCandidateIndex::RemoveLevel(const ULevel* Level)
+{
+	if (!Level) return;
+
+	//Iterate backwards, removal swaps the last entry in
+	for (int32 i = Actors.Num() - 1; i >= 0; i--)
+	{
+		const AActor* Actor = Actors[i].Get();
+		if (!Actor || Actor->GetLevel() == Level)
+		{
+			RemoveAt(i);
+		}
+	}
+}
+
+void FTargetLockCandidateIndex::Query(const FVector& Origin, double Radius, TArray<AActor*>& OutActors) const
+{
+	const FIntVector MinCell = GetCell(Origin - FVector(Radius));
+	const FIntVector MaxCell = GetCell(Origin + FVector(Radius));
+	const float RadiusSquared = static_cast<float>(Radius * Radius);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+			{
+				const FIntVector Cell(X, Y, Z);
+				const TPair<int32, int32>* Range = CellRanges.Find(Cell);
+				if (!Range) continue;
+
+				//Doubles only once per cell, the loop over its entries stays in floats
+				const FVector3f LocalOrigin(Origin - GetCellOrigin(Cell));
+				const int32 End = Range->Key + Range->Value;
+				for (int32 i = Range->Key; i < End; i++)
+				{
+					if ((LocalPositions[i] - LocalOrigin).SizeSquared() > RadiusSquared) continue;
+
+					if (AActor* Actor = SortedActors[i].Get())
+					{
+						OutActors.Add(Actor);
+					}
+				}
+			}
+		}
+	}
+}
+
+void FTargetLockCandidateIndex::Reset()
+{
+	Actors.Reset();
+	Keys.Reset();
+	Lookup.Reset();
+	SortedIndices.Reset();
+	SortedActors.Reset();
+	LocalPositions.Reset();
+	CellRanges.Reset();
+}
+
+void FTargetLockCandidateIndex::Rebuild()
+{
+	bStale = false;
+
+	//Actors that went away without a destroy event, e.g. garbage collected ones
+	for (int32 i = Actors.Num() - 1; i >= 0; i--)
+	{
+		if (!Actors[i].IsValid())
+		{
+			RemoveAt(i);
+		}
+	}
+
+	struct FEntry
+	{
+		FIntVector Cell;
+		FVector Location;
+		int32 Index;
+	};
+
+	TArray<FEntry> Entries;
+	Entries.Reserve(Actors.Num());
+	for (int32 i = 0; i < Actors.Num(); i++)
+	{
+		const FVector Location = Actors[i]->GetActorLocation();
+		Entries.Add({ GetCell(Location), Location, i });
+	}
+
+	Entries.Sort([](const FEntry& A, const FEntry& B)
+	{
+		if (A.Cell.X != B.Cell.X) return A.Cell.X < B.Cell.X;
+		if (A.Cell.Y != B.Cell.Y) return A.Cell.Y < B.Cell.Y;
+		return A.Cell.Z < B.Cell.Z;
+	});
+
+	SortedActors.Reset(Entries.Num());
+	LocalPositions.Reset(Entries.Num());
+	CellRanges.Reset();
+
+	for (int32 i = 0; i < Entries.Num(); i++)
+	{
+		const FEntry& Entry = Entries[i];
+		SortedIndices[Entry.Index] = SortedActors.Add(Actors[Entry.Index]);
+		LocalPositions.Add(FVector3f(Entry.Location - GetCellOrigin(Entry.Cell)));
+
+		if (i == 0 || Entries[i - 1].Cell != Entry.Cell)
+		{
+			CellRanges.Add(Entry.Cell, { i, 0 });
+		}
+		CellRanges[Entry.Cell].Value++;
+	}
+}
+
+FIntVector FTargetLockCandidateIndex::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
+
+FVector FTargetLockCandidateIndex::GetCellOrigin(const FIntVector& Cell) const
+{
+	return FVector(Cell) * CellSize;
+}
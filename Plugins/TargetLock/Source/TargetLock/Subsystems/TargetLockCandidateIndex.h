@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class AActor;
+class ULevel;
+
+/**
+ * Spatial hash of the actors that can be locked onto, kept up to date by the UTargetLockSubsystem through
+ * level streaming and actor spawn/destroy events instead of asking physics for overlaps.
+ * Locations are stored as float offsets relative to the origin of their cell, so the search loop runs on
+ * floats while the index itself works with the double precision positions of large worlds.
+ */
+class TARGETLOCK_API FTargetLockCandidateIndex
+{
+public:
+	explicit FTargetLockCandidateIndex(double InCellSize = 2500);
+
+	void Add(AActor* Actor);
+	void Remove(const AActor* Actor);
+
+	//Adds all actors of a freshly streamed in level at once
+	void AddLevel(const ULevel* Level, TFunctionRef<bool(const AActor*)> Filter);
+
+	//Drops all actors of a level that streamed out
+	void RemoveLevel(const ULevel* Level);
+
+	/**
+	 * Appends the indexed actors within the radius, at their locations of the last Rebuild.
+	 * Actors added since then are found after the next Rebuild, removed ones are skipped right away.
+	 */
+	void Query(const FVector& Origin, double Radius, TArray<AActor*>& OutActors) const;
+
+	//Re-buckets all actors from their current locations
+	void Rebuild();
+
+	//The stored locations are outdated, e.g. a new frame started. The subsystem rebuilds before the next query then.
+	void MarkStale() { bStale = true; }
+	bool IsStale() const { return bStale; }
+
+	int32 Num() const { return Actors.Num(); }
+
+	void Reset();
+
+private:
+	void RemoveAt(int32 Index);
+
+	FIntVector GetCell(const FVector& Location) const;
+	FVector GetCellOrigin(const FIntVector& Cell) const;
+
+	double CellSize;
+
+	bool bStale = false;
+
+	//Every indexed actor, unordered. Removal swaps the last entry in.
+	TArray<TWeakObjectPtr<AActor>> Actors;
+
+	//Parallel to Actors, still valid for actors that got destroyed without us noticing
+	TArray<TObjectKey<AActor>> Keys;
+	TMap<TObjectKey<AActor>, int32> Lookup;
+
+	//Parallel to Actors, the entry in SortedActors or INDEX_NONE until the next Rebuild
+	TArray<int32> SortedIndices;
+
+	//Filled by Rebuild, sorted by cell. Positions are relative to the origin of their cell.
+	TArray<TWeakObjectPtr<AActor>> SortedActors;
+	TArray<FVector3f> LocalPositions;
+	TMap<FIntVector, TPair<int32, int32>> CellRanges;
+};
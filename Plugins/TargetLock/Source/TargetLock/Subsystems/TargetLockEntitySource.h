@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TargetLock/Data/TargetLockData.h"
+
+/**
+ * Feeds lock targets that are not actors into the UTargetLockSubsystem, e.g. crowd agents of an ECS.
+ * See UTargetLockSubsystem::SetEntitySource, the optional TargetLockMass plugin implements this for MassEntity.
+ */
+class TARGETLOCK_API ITargetLockEntitySource
+{
+public:
+	virtual ~ITargetLockEntitySource() = default;
+
+	/**
+	 * Appends every lockable entity within the radius. Entities are not in the candidate index of the subsystem,
+	 * the source keeps its own spatial lookup from the data it already iterates every frame.
+	 *
+	 * @param OutTargets The found entities.
+	 * @param OutLocations Aim location of every found entity, parallel to OutTargets.
+	 */
+	virtual void GatherEntities(const FVector& Origin, float Radius, TArray<FTargetLockTargetHandle>& OutTargets, TArray<FVector>& OutLocations) const = 0;
+
+	//Current aim location of the entity. False if the entity is gone or no longer lockable.
+	virtual bool GetEntityLocation(const FTargetLockTargetHandle& Target, FVector& OutLocation) const = 0;
+};
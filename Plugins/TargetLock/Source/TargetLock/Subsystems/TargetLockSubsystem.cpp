@@ -0,0 +1,1324 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "TargetLock/Visualization/TargetLockIndicatorRenderer.h"
+#include "TargetLock/Data/TargetLockConfig.h"
+#include "TargetLock/Subsystems/TargetLockEntitySource.h"
+#include "TargetLock/Components/TargetLockTrackerComponent.h"
+#include "TargetLock/Interfaces/TargetLockTargetInterface.h"
+#include "TargetLock/Visibility/TargetLockVisibilityProvider.h"
+#include "TargetLock/Visibility/TargetLockVisibilityVolume.h"
+#include "TargetLockUtilities.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "AIController.h"
+#include "Camera/CameraComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Actor.h"
+#include "WorldCollision.h"
+
+namespace TargetLockBatch
+{
+	//Results nobody picked up are dropped after this many seconds
+	constexpr double AcquisitionResultLifetime = 2.0;
+
+	//How often cached tag query results of destroyed targets get dropped
+	constexpr double TagQueryCachePruneInterval = 5.0;
+
+	//Worker searches trace at most this many of their best candidates. Also the stride of the trace user data.
+	constexpr uint32 MaxAsyncLineOfSightCandidates = 4;
+
+	enum EAsyncLineOfSightResult : uint8
+	{
+		Pending,
+		Clear,
+		Blocked
+	};
+
+	//Interleaves the quantized position bits so lockers close to each other end up next to each other after sorting
+	uint32 GetMortonKey(const FVector& Location, const FVector& Min, double CellSize)
+	{
+		const FVector Cell = (Location - Min) / CellSize;
+		const uint32 X = FMath::Clamp(FMath::FloorToInt32(Cell.X), 0, 1023);
+		const uint32 Y = FMath::Clamp(FMath::FloorToInt32(Cell.Y), 0, 1023);
+		const uint32 Z = FMath::Clamp(FMath::FloorToInt32(Cell.Z), 0, 1023);
+		return FMath::MortonCode3(X) | (FMath::MortonCode3(Y) << 1) | (FMath::MortonCode3(Z) << 2);
+	}
+}
+
+bool UTargetLockSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTargetLockSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	//Keeps the candidate index in sync with what is loaded, cells of World Partition stream in as levels
+	FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UTargetLockSubsystem::OnLevelAddedToWorld);
+	FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UTargetLockSubsystem::OnLevelRemovedFromWorld);
+
+	UWorld* World = GetWorld();
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UTargetLockSubsystem::OnActorSpawned));
+	ActorDestroyedHandle = World->AddOnActorDestroyededHandler(FOnActorDestroyed::FDelegate::CreateUObject(this, &UTargetLockSubsystem::OnActorDestroyed));
+
+	NumSubsystems++;
+}
+
+void UTargetLockSubsystem::Deinitialize()
+{
+	//The worker may still be scoring, its batch must not go away under it
+	if (AsyncAcquisitionBatch)
+	{
+		AsyncAcquisitionTask.Wait();
+		AsyncAcquisitionBatch.Reset();
+	}
+	AsyncLineOfSightRequests.Empty();
+
+	while (ActiveLocks.Num() > 0)
+	{
+		RemoveActiveLockAt(ActiveLocks.Num() - 1);
+	}
+
+	for (TPair<TObjectPtr<UClass>, FTargetLockVisualizeActorPool>& Pool : VisualizeActorPools)
+	{
+		for (AActor* VisualizeActor : Pool.Value.FreeActors)
+		{
+			if (IsValid(VisualizeActor))
+			{
+				VisualizeActor->Destroy();
+			}
+		}
+	}
+	VisualizeActorPools.Empty();
+
+	for (FTargetLockIndicatorBatch& Batch : IndicatorBatches)
+	{
+		if (IsValid(Batch.Renderer))
+		{
+			Batch.Renderer->Destroy();
+		}
+	}
+	IndicatorBatches.Empty();
+	IndicatorLookup.Empty();
+
+	for (TPair<TObjectKey<AActor>, FTargetTagQueryCacheEntry>& Entry : TargetTagQueryCache)
+	{
+		if (UAbilitySystemComponent* AbilitySystem = Entry.Value.AbilitySystem.Get())
+		{
+			AbilitySystem->RegisterGenericGameplayTagEvent().Remove(Entry.Value.TagChangedHandle);
+		}
+	}
+	TargetTagQueryCache.Empty();
+
+	FWorldDelegates::LevelAddedToWorld.RemoveAll(this);
+	FWorldDelegates::LevelRemovedFromWorld.RemoveAll(this);
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+		World->RemoveOnActorDestroyededHandler(ActorDestroyedHandle);
+	}
+	CandidateIndex.Reset();
+	IndexedClasses.Empty();
+
+	if (DebugStatsRequestTime >= 0)
+	{
+		DebugStatsRequestTime = -1;
+		FTargetLockDebugStats::NumCollectingWorlds--;
+	}
+
+	//Queries registered by edited configs or inline task data would pile up over PIE sessions otherwise
+	if (--NumSubsystems == 0)
+	{
+		TargetTagQueries.Empty();
+		TargetTagQueryGeneration++;
+	}
+
+	Super::Deinitialize();
+}
+
+void UTargetLockSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (FTargetLockDebugStats* Stats = GetDebugStats())
+	{
+		Stats->EndFrame();
+	}
+
+	{
+		FTargetLockScopedDebugTimer AcquisitionTimer(this, ETargetLockDebugTimer::Acquisition);
+
+		//Moving targets have to be found where they are now, the first query of the frame rebuilds the index.
+		//Frames without any indexed search don't pay for it.
+		CandidateIndex.MarkStale();
+		FlushAcquisitionRequests();
+	}
+	{
+		FTargetLockScopedDebugTimer SolveTimer(this, ETargetLockDebugTimer::Solve);
+		UpdateActiveLocks(DeltaTime);
+	}
+	UpdateLockIndicators();
+	PruneTargetTagQueryCache();
+}
+
+void UTargetLockSubsystem::RequestDebugStats(const AActor* FocusActor)
+{
+	if (DebugStatsRequestTime < 0)
+	{
+		FTargetLockDebugStats::NumCollectingWorlds++;
+	}
+	DebugStatsRequestTime = GetWorld()->GetRealTimeSeconds();
+	if (DebugStats.FocusActor.Get() != FocusActor)
+	{
+		DebugStats.FocusActor = FocusActor;
+		DebugStats.Candidates.Reset();
+	}
+}
+
+void UTargetLockSubsystem::RegisterVisibilityVolume(ATargetLockVisibilityVolume* Volume)
+{
+	VisibilityVolumes.AddUnique(Volume);
+}
+
+void UTargetLockSubsystem::UnregisterVisibilityVolume(ATargetLockVisibilityVolume* Volume)
+{
+	VisibilityVolumes.Remove(Volume);
+}
+
+bool UTargetLockSubsystem::IsStaticallyBlocked(const FVector& From, const FVector& To, float Margin) const
+{
+	for (const TWeakObjectPtr<ATargetLockVisibilityVolume>& Volume : VisibilityVolumes)
+	{
+		if (Volume.IsValid() && Volume->IsStaticallyBlocked(From, To, Margin)) return true;
+	}
+	return false;
+}
+
+FTargetLockDebugStats* UTargetLockSubsystem::GetDebugStats()
+{
+	if (DebugStatsRequestTime < 0) return nullptr;
+
+	if (GetWorld()->GetRealTimeSeconds() - DebugStatsRequestTime > 1.0)
+	{
+		DebugStatsRequestTime = -1;
+		DebugStats = FTargetLockDebugStats();
+		FTargetLockDebugStats::NumCollectingWorlds--;
+		return nullptr;
+	}
+	return &DebugStats;
+}
+
+TStatId UTargetLockSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTargetLockSubsystem, STATGROUP_Tickables);
+}
+
+AActor* UTargetLockSubsystem::AcquireVisualizeActor(TSubclassOf<AActor> VisualizeActorClass, AActor* AttachTo)
+{
+	if (!VisualizeActorClass) return nullptr;
+
+	AActor* VisualizeActor = nullptr;
+	if (FTargetLockVisualizeActorPool* Pool = VisualizeActorPools.Find(VisualizeActorClass.Get()))
+	{
+		//Actors in the pool may have been destroyed from the outside (e.g. by a level reset), skip those
+		while (!VisualizeActor && Pool->FreeActors.Num() > 0)
+		{
+			AActor* Candidate = Pool->FreeActors.Pop(false);
+			if (IsValid(Candidate))
+			{
+				VisualizeActor = Candidate;
+			}
+		}
+	}
+
+	if (!VisualizeActor)
+	{
+		VisualizeActor = SpawnPooledVisualizeActor(VisualizeActorClass);
+		if (!VisualizeActor) return nullptr;
+	}
+
+	if (AttachTo)
+	{
+		VisualizeActor->AttachToActor(AttachTo, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+	}
+	SetVisualizeActorActive(VisualizeActor, true);
+
+	return VisualizeActor;
+}
+
+void UTargetLockSubsystem::ReleaseVisualizeActor(AActor* VisualizeActor)
+{
+	if (!IsValid(VisualizeActor)) return;
+
+	VisualizeActor->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	SetVisualizeActorActive(VisualizeActor, false);
+
+	FTargetLockVisualizeActorPool& Pool = VisualizeActorPools.FindOrAdd(VisualizeActor->GetClass());
+	Pool.FreeActors.AddUnique(VisualizeActor);
+}
+
+void UTargetLockSubsystem::PrewarmVisualizeActors(TSubclassOf<AActor> VisualizeActorClass, int32 Count)
+{
+	if (!VisualizeActorClass) return;
+
+	FTargetLockVisualizeActorPool& Pool = VisualizeActorPools.FindOrAdd(VisualizeActorClass.Get());
+	for (int32 i = Pool.FreeActors.Num(); i < Count; i++)
+	{
+		if (AActor* VisualizeActor = SpawnPooledVisualizeActor(VisualizeActorClass))
+		{
+			SetVisualizeActorActive(VisualizeActor, false);
+			Pool.FreeActors.Add(VisualizeActor);
+		}
+	}
+}
+
+AActor* UTargetLockSubsystem::SpawnPooledVisualizeActor(UClass* VisualizeActorClass)
+{
+	UWorld* World = GetWorld();
+	if (!World) return nullptr;
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+
+	return World->SpawnActor(VisualizeActorClass, nullptr, nullptr, SpawnParameters);
+}
+
+void UTargetLockSubsystem::SetVisualizeActorActive(AActor* VisualizeActor, bool bActive)
+{
+	VisualizeActor->SetActorHiddenInGame(!bActive);
+	VisualizeActor->SetActorEnableCollision(bActive);
+	VisualizeActor->SetActorTickEnabled(bActive);
+}
+
+int32 UTargetLockSubsystem::AddLockIndicator(UStaticMesh* Mesh, AActor* Target, FVector Offset, float Scale)
+{
+	if (!IsValid(Target)) return INDEX_NONE;
+
+	return AddLockIndicatorForTarget(Mesh, FTargetLockTargetHandle::FromActor(Target), Offset, Scale);
+}
+
+int32 UTargetLockSubsystem::AddLockIndicatorForTarget(UStaticMesh* Mesh, const FTargetLockTargetHandle& Target, FVector Offset, float Scale)
+{
+	if (!Mesh || !Target.IsSet()) return INDEX_NONE;
+
+	FTargetLockIndicatorBatch* Batch = FindOrAddIndicatorBatch(Mesh);
+	if (!Batch) return INDEX_NONE;
+
+	const int32 IndicatorId = NextIndicatorId++;
+	const int32 Slot = Batch->IndicatorIds.Add(IndicatorId);
+	Batch->Targets.Add(Target);
+	Batch->Offsets.Add(Offset);
+	Batch->Scales.Add(Scale);
+
+	IndicatorLookup.Add(IndicatorId, { static_cast<int32>(Batch - IndicatorBatches.GetData()), Slot });
+	return IndicatorId;
+}
+
+void UTargetLockSubsystem::RemoveLockIndicator(int32 IndicatorId)
+{
+	TPair<int32, int32> Location;
+	if (!IndicatorLookup.RemoveAndCopyValue(IndicatorId, Location)) return;
+
+	FTargetLockIndicatorBatch& Batch = IndicatorBatches[Location.Key];
+	const int32 Slot = Location.Value;
+	const int32 LastSlot = Batch.IndicatorIds.Num() - 1;
+
+	//Swap the last indicator into the freed slot to keep the arrays dense
+	if (Slot != LastSlot)
+	{
+		const int32 MovedId = Batch.IndicatorIds[LastSlot];
+		IndicatorLookup[MovedId].Value = Slot;
+	}
+	Batch.IndicatorIds.RemoveAtSwap(Slot, 1, false);
+	Batch.Targets.RemoveAtSwap(Slot, 1, false);
+	Batch.Offsets.RemoveAtSwap(Slot, 1, false);
+	Batch.Scales.RemoveAtSwap(Slot, 1, false);
+}
+
+void UTargetLockSubsystem::UpdateLockIndicators()
+{
+	for (FTargetLockIndicatorBatch& Batch : IndicatorBatches)
+	{
+		if (!IsValid(Batch.Renderer)) continue;
+
+		const int32 Count = Batch.Targets.Num();
+		Batch.Transforms.SetNumUninitialized(Count, false);
+
+		for (int32 i = 0; i < Count; i++)
+		{
+			//Targets that went away keep their slot until the owner removes the indicator, just don't draw them
+			FVector TargetLocation;
+			Batch.Transforms[i] = GetTargetLocation(Batch.Targets[i], TargetLocation)
+				? FTransform(FQuat::Identity, TargetLocation + Batch.Offsets[i], FVector(Batch.Scales[i]))
+				: FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+		}
+
+		Batch.Renderer->UpdateIndicators(Batch.Transforms);
+	}
+}
+
+FTargetLockIndicatorBatch* UTargetLockSubsystem::FindOrAddIndicatorBatch(UStaticMesh* Mesh)
+{
+	for (FTargetLockIndicatorBatch& Batch : IndicatorBatches)
+	{
+		if (Batch.Mesh == Mesh && IsValid(Batch.Renderer))
+		{
+			return &Batch;
+		}
+	}
+
+	UWorld* World = GetWorld();
+	if (!World) return nullptr;
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+
+	ATargetLockIndicatorRenderer* Renderer = World->SpawnActor<ATargetLockIndicatorRenderer>(ATargetLockIndicatorRenderer::StaticClass(), FTransform::Identity, SpawnParameters);
+	if (!Renderer) return nullptr;
+	Renderer->SetIndicatorMesh(Mesh);
+
+	//Reuse the slot of a batch whose renderer got destroyed from the outside
+	for (FTargetLockIndicatorBatch& Batch : IndicatorBatches)
+	{
+		if (Batch.Mesh == Mesh)
+		{
+			Batch.Renderer = Renderer;
+			return &Batch;
+		}
+	}
+
+	FTargetLockIndicatorBatch& Batch = IndicatorBatches.AddDefaulted_GetRef();
+	Batch.Mesh = Mesh;
+	Batch.Renderer = Renderer;
+	return &Batch;
+}
+
+FTargetLockHandle UTargetLockSubsystem::StartLock(AActor* Owner, UTargetLockConfig* Config, UCameraComponent* OptionalCamera)
+{
+	if (!IsValid(Owner) || !Config) return {};
+
+	//Locks without a camera (AI) look from the view point of the owner
+	UCameraComponent* Camera = OptionalCamera ? OptionalCamera : Owner->FindComponentByClass<UCameraComponent>();
+
+	//Take the target of the background tracker if it tracks for this config, otherwise search now
+	FTargetLockTargetHandle Target;
+	const UTargetLockTrackerComponent* Tracker = Owner->FindComponentByClass<UTargetLockTrackerComponent>();
+	AActor* TrackedTarget = Tracker && Tracker->IsTrackingFor(Config) ? Tracker->GetValidWouldLockTarget() : nullptr;
+	if (TrackedTarget)
+	{
+		Target = FTargetLockTargetHandle::FromActor(TrackedTarget);
+	}
+	else
+	{
+		Target = FindBestTargetHandle(Config->Data, Owner, UTargetLockUtilities::GetViewPoint(Owner, Camera));
+	}
+	if (!Target.IsSet()) return {};
+	AActor* TargetActor = Target.GetActor();
+
+	//An owner only ever runs one lock
+	StopLock(FindLockByOwner(Owner));
+
+	FTargetLockActiveLock& Lock = ActiveLocks.AddDefaulted_GetRef();
+	Lock.Handle.Id = NextLockId++;
+	Lock.OwnerKey = Owner;
+	Lock.Owner = Owner;
+	Lock.Camera = Camera;
+	Lock.Target = Target;
+	Lock.Config = Config;
+
+	switch (Config->Data.VisualizeMode)
+	{
+	case ETargetLockVisualizeMode::Actor:
+		//Visualize actors get attached, entities have nothing to attach to
+		Lock.VisualizeActor = TargetActor ? AcquireVisualizeActor(Config->Data.TargetLockVisualizeActorClass, TargetActor) : nullptr;
+		break;
+	case ETargetLockVisualizeMode::Instanced:
+		Lock.IndicatorId = AddLockIndicatorForTarget(Config->Data.TargetLockIndicatorMesh, Target,
+			Config->Data.TargetLockIndicatorOffset, Config->Data.TargetLockIndicatorScale);
+		break;
+	}
+
+	//Entity targets get their focal point updated with every lock update instead
+	AAIController* AIController = Cast<AAIController>(UTargetLockUtilities::GetLockController(Owner));
+	if (AIController && TargetActor)
+	{
+		AIController->SetFocus(TargetActor, EAIFocusPriority::Gameplay);
+	}
+
+	BindLockTargetEvents(Lock);
+
+	LockIndices.Add(Lock.Handle.Id, ActiveLocks.Num() - 1);
+	LocksByOwner.Add(Owner, Lock.Handle);
+	return Lock.Handle;
+}
+
+void UTargetLockSubsystem::StopLock(FTargetLockHandle Handle)
+{
+	if (const int32* Index = LockIndices.Find(Handle.Id))
+	{
+		RemoveActiveLockAt(*Index);
+	}
+}
+
+FTargetLockHandle UTargetLockSubsystem::FindLockByOwner(const AActor* Owner) const
+{
+	const FTargetLockHandle* Handle = LocksByOwner.Find(Owner);
+	return Handle ? *Handle : FTargetLockHandle();
+}
+
+AActor* UTargetLockSubsystem::GetLockTarget(FTargetLockHandle Handle) const
+{
+	const int32* Index = LockIndices.Find(Handle.Id);
+	return Index ? ActiveLocks[*Index].Target.GetActor() : nullptr;
+}
+
+FTargetLockTargetHandle UTargetLockSubsystem::GetLockTargetHandle(FTargetLockHandle Handle) const
+{
+	const int32* Index = LockIndices.Find(Handle.Id);
+	return Index ? ActiveLocks[*Index].Target : FTargetLockTargetHandle();
+}
+
+void UTargetLockSubsystem::SetEntitySource(ITargetLockEntitySource* Source)
+{
+	EntitySource = Source;
+}
+
+bool UTargetLockSubsystem::GetTargetLocation(const FTargetLockTargetHandle& Target, FVector& OutLocation) const
+{
+	if (Target.IsEntity())
+	{
+		return EntitySource && EntitySource->GetEntityLocation(Target, OutLocation);
+	}
+
+	const AActor* Actor = Target.GetActor();
+	if (!Actor) return false;
+
+	OutLocation = Actor->GetActorLocation();
+	return true;
+}
+
+FTargetLockTargetHandle UTargetLockSubsystem::FindBestTargetHandle(const FStruct_TargetLockData& Config, AActor* Owner,
+	const FTargetLockViewPoint& ViewPoint)
+{
+	if (!Owner) return {};
+
+	if (!Config.LockOntoEntities || !EntitySource)
+	{
+		return FTargetLockTargetHandle::FromActor(UTargetLockUtilities::FindBestTargetFromViewPoint(this, Config, Owner, ViewPoint));
+	}
+
+	//Actors and entities go through one snapshot, so they get filtered and scored by the same rules as every other search
+	FTargetLockAsyncAcquisition Acquisition;
+	TArray<AActor*> Candidates;
+	SnapshotAcquisition(Acquisition, Config, Owner, ViewPoint, nullptr, Candidates);
+	const int32 NumActors = Acquisition.Candidates.Num();
+
+	//Entities own no tags: they pass the tag checks only if the query accepts a target without any tags
+	TArray<FTargetLockTargetHandle> Entities;
+	if (Config.TargetTagQuery.IsEmpty() || Config.TargetTagQuery.Matches(FGameplayTagContainer()))
+	{
+		TArray<FVector> Locations;
+		EntitySource->GatherEntities(ViewPoint.Location, Config.MaxDistanceToStartTargetLock, Entities, Locations);
+
+		Acquisition.Candidates.AddDefaulted(Entities.Num());
+		Acquisition.Locations.Append(Locations);
+		Acquisition.Threats.AddZeroed(Entities.Num());
+		Acquisition.DamagedAlphas.AddZeroed(Entities.Num());
+	}
+
+	//Only baked curves are used, so this is the same scoring the worker does
+	Acquisition.Score();
+
+	for (const int32 Index : Acquisition.Order)
+	{
+		if (Index < NumActors)
+		{
+			AActor* Actor = Acquisition.Candidates[Index].Get();
+			if (!Actor) continue;
+			if (Config.DoLineOfSightCheck && !UTargetLockUtilities::HasLineOfSightToTarget(this, Config, ViewPoint, Owner, Actor))
+				continue;
+
+			return FTargetLockTargetHandle::FromActor(Actor);
+		}
+
+		if (Config.DoLineOfSightCheck && !UTargetLockUtilities::HasLineOfSightToLocation(this, Config, ViewPoint, Owner, Acquisition.Locations[Index]))
+			continue;
+
+		return Entities[Index - NumActors];
+	}
+
+	return {};
+}
+
+void UTargetLockSubsystem::UpdateActiveLocks(float DeltaTime)
+{
+	//Iterate backwards, broken locks get swapped out of the array
+	for (int32 i = ActiveLocks.Num() - 1; i >= 0; i--)
+	{
+		if (!UpdateActiveLock(ActiveLocks[i], DeltaTime))
+		{
+			RemoveActiveLockAt(i);
+		}
+	}
+}
+
+bool UTargetLockSubsystem::UpdateActiveLock(FTargetLockActiveLock& Lock, float DeltaTime)
+{
+	AActor* Owner = Lock.Owner.Get();
+	FVector TargetLocation;
+	if (!Owner || !Lock.Config || !GetTargetLocation(Lock.Target, TargetLocation)) return false;
+
+	const FStruct_TargetLockData& Config = Lock.Config->Data;
+	const FTargetLockViewPoint ViewPoint = UTargetLockUtilities::GetViewPoint(Owner, Lock.Camera.Get());
+
+	bool bStillLockable;
+	if (AActor* Target = Lock.Target.GetActor())
+	{
+		bStillLockable = UTargetLockUtilities::IsTargetStillLockable(this, Config, Owner, ViewPoint, Target);
+	}
+	else
+	{
+		bStillLockable = UTargetLockUtilities::IsWithinBreakThresholds(Config, ViewPoint, TargetLocation) &&
+			(!Config.ContinuousLineOfSightCheck || UTargetLockUtilities::HasLineOfSightToLocation(this, Config, ViewPoint, Owner, TargetLocation));
+	}
+	if (UTargetLockUtilities::UpdateLockBreakTimer(Config, bStillLockable, DeltaTime, Lock.BreakTimer))
+	{
+		return false;
+	}
+
+	AController* Controller = UTargetLockUtilities::GetLockController(Owner);
+	if (!Controller) return true;
+
+	//AI controllers rotate through their focus, entities can't be focused so their location is
+	if (AAIController* AIController = Cast<AAIController>(Controller))
+	{
+		if (Lock.Target.IsEntity())
+		{
+			AIController->SetFocalPoint(TargetLocation, EAIFocusPriority::Gameplay);
+		}
+		return true;
+	}
+
+	float Angle = 0;
+	const FRotator RotationDelta = UTargetLockUtilities::ComputeLockRotationDelta(Config, ViewPoint.Location,
+		ViewPoint.Forward, TargetLocation, Controller->GetControlRotation(), DeltaTime, Angle);
+
+	if (Angle < Config.AngleToStartLerp) return true;
+
+	Controller->SetControlRotation(Controller->GetControlRotation() + RotationDelta);
+	return true;
+}
+
+void UTargetLockSubsystem::RemoveActiveLockAt(int32 Index)
+{
+	FTargetLockActiveLock Lock = MoveTemp(ActiveLocks[Index]);
+
+	UnbindLockTargetEvents(Lock);
+	ReleaseVisualizeActor(Lock.VisualizeActor);
+	RemoveLockIndicator(Lock.IndicatorId);
+
+	if (AAIController* AIController = Cast<AAIController>(UTargetLockUtilities::GetLockController(Lock.Owner.Get())))
+	{
+		AIController->ClearFocus(EAIFocusPriority::Gameplay);
+	}
+
+	LockIndices.Remove(Lock.Handle.Id);
+	if (const FTargetLockHandle* OwnerHandle = LocksByOwner.Find(Lock.OwnerKey))
+	{
+		if (*OwnerHandle == Lock.Handle)
+		{
+			LocksByOwner.Remove(Lock.OwnerKey);
+		}
+	}
+
+	ActiveLocks.RemoveAtSwap(Index, 1, false);
+	if (ActiveLocks.IsValidIndex(Index))
+	{
+		LockIndices[ActiveLocks[Index].Handle.Id] = Index;
+	}
+
+	OnLockEnded.Broadcast(Lock.Handle);
+}
+
+void UTargetLockSubsystem::BindLockTargetEvents(FTargetLockActiveLock& Lock)
+{
+	AActor* Target = Lock.Target.GetActor();
+	if (!Target || !Lock.Config) return;
+
+	int32& BoundCount = BoundTargetCounts.FindOrAdd(Target);
+	if (BoundCount++ == 0)
+	{
+		Target->OnDestroyed.AddUniqueDynamic(this, &UTargetLockSubsystem::OnLockTargetDestroyed);
+		Target->OnEndPlay.AddUniqueDynamic(this, &UTargetLockSubsystem::OnLockTargetEndPlay);
+	}
+
+	Lock.TargetTagEvents.Bind(Target, Lock.Config->Data.UntargetableTags,
+		FOnGameplayEffectTagCountChanged::FDelegate::CreateUObject(this, &UTargetLockSubsystem::OnLockTargetTagChanged, Lock.Handle));
+
+	if (Lock.Config->Data.BreakLockOnTargetTeleport)
+	{
+		if (USceneComponent* TargetRoot = Target->GetRootComponent())
+		{
+			Lock.TargetTransformUpdatedHandle = TargetRoot->TransformUpdated.AddUObject(this, &UTargetLockSubsystem::OnLockTargetTransformUpdated, Lock.Handle);
+		}
+	}
+}
+
+void UTargetLockSubsystem::UnbindLockTargetEvents(FTargetLockActiveLock& Lock)
+{
+	Lock.TargetTagEvents.Unbind();
+
+	AActor* Target = Lock.Target.GetActor();
+	if (!Target) return;
+
+	if (USceneComponent* TargetRoot = Target->GetRootComponent())
+	{
+		TargetRoot->TransformUpdated.Remove(Lock.TargetTransformUpdatedHandle);
+	}
+	Lock.TargetTransformUpdatedHandle.Reset();
+
+	if (int32* BoundCount = BoundTargetCounts.Find(Target))
+	{
+		if (--(*BoundCount) <= 0)
+		{
+			BoundTargetCounts.Remove(Target);
+			Target->OnDestroyed.RemoveDynamic(this, &UTargetLockSubsystem::OnLockTargetDestroyed);
+			Target->OnEndPlay.RemoveDynamic(this, &UTargetLockSubsystem::OnLockTargetEndPlay);
+		}
+	}
+}
+
+void UTargetLockSubsystem::StopLocksOnTarget(const AActor* Target)
+{
+	for (int32 i = ActiveLocks.Num() - 1; i >= 0; i--)
+	{
+		if (!ActiveLocks[i].Target.IsEntity() && ActiveLocks[i].Target.GetActor() == Target)
+		{
+			RemoveActiveLockAt(i);
+		}
+	}
+}
+
+void UTargetLockSubsystem::OnLockTargetDestroyed(AActor* DestroyedActor)
+{
+	StopLocksOnTarget(DestroyedActor);
+}
+
+void UTargetLockSubsystem::OnLockTargetEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason)
+{
+	StopLocksOnTarget(Actor);
+}
+
+void UTargetLockSubsystem::OnLockTargetTagChanged(const FGameplayTag Tag, int32 NewCount, FTargetLockHandle Handle)
+{
+	if (NewCount > 0)
+	{
+		StopLock(Handle);
+	}
+}
+
+void UTargetLockSubsystem::OnLockTargetTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags,
+	ETeleportType Teleport, FTargetLockHandle Handle)
+{
+	if (Teleport != ETeleportType::None)
+	{
+		StopLock(Handle);
+	}
+}
+
+void UTargetLockSubsystem::FindBestTargetsBatch(const TArray<FTargetLockLocker>& Lockers, TArray<AActor*>& OutTargets)
+{
+	OutTargets.Reset(Lockers.Num());
+	OutTargets.AddZeroed(Lockers.Num());
+
+	UWorld* World = GetWorld();
+	if (!World || Lockers.Num() == 0) return;
+
+	//Collect the valid lockers and the extents of the whole batch
+	TArray<int32> Order;
+	Order.Reserve(Lockers.Num());
+	FBox BatchBounds(ForceInit);
+	double MaxRadius = 0;
+	FCollisionObjectQueryParams ObjectParams;
+	for (int32 i = 0; i < Lockers.Num(); i++)
+	{
+		const FTargetLockLocker& Locker = Lockers[i];
+		if (!Locker.Owner || !Locker.Config) continue;
+
+		//The candidate index is cheap to ask, these lockers don't need to share an overlap
+		if (Locker.Config->Data.CandidateSource == ETargetLockCandidateSource::CandidateIndex)
+		{
+			TArray<AActor*> IndexedCandidates;
+			GatherIndexedCandidates(Locker.Config->Data, Locker.Owner->GetActorLocation(), Locker.Config->Data.MaxDistanceToStartTargetLock, IndexedCandidates);
+			OutTargets[i] = UTargetLockUtilities::SelectBestTarget(this, Locker.Config->Data, Locker.Owner,
+				Locker.ViewPoint, IndexedCandidates, false, Locker.CurrentTarget);
+			continue;
+		}
+
+		Order.Add(i);
+		BatchBounds += Locker.Owner->GetActorLocation();
+		MaxRadius = FMath::Max(MaxRadius, static_cast<double>(Locker.Config->Data.MaxDistanceToStartTargetLock));
+
+		//The shared overlaps query the object types of all lockers
+		for (const TEnumAsByte<EObjectTypeQuery>& ObjectType : Locker.Config->Data.AcquisitionObjectTypes)
+		{
+			ObjectParams.AddObjectTypesToQuery(UEngineTypes::ConvertToCollisionChannel(ObjectType));
+		}
+	}
+	if (Order.Num() == 0 || MaxRadius <= 0 || !ObjectParams.IsValid()) return;
+
+	//Sort spatially, cells are as big as the largest search radius
+	TArray<uint32> Keys;
+	Keys.SetNumUninitialized(Lockers.Num());
+	for (const int32 Index : Order)
+	{
+		Keys[Index] = TargetLockBatch::GetMortonKey(Lockers[Index].Owner->GetActorLocation(), BatchBounds.Min, MaxRadius);
+	}
+	Order.Sort([&Keys](const int32 A, const int32 B) { return Keys[A] < Keys[B]; });
+
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TargetLockBatchAcquisition), false);
+
+	TArray<FOverlapResult> Overlaps;
+	TArray<AActor*> Candidates;
+	TSet<AActor*> SeenCandidates;
+
+	//Group neighbouring lockers while their locations stay within one search radius of each other,
+	//every group gathers its candidates with one overlap that covers the search spheres of all its lockers
+	int32 GroupStart = 0;
+	while (GroupStart < Order.Num())
+	{
+		FBox GroupBounds(ForceInit);
+		double GroupRadius = 0;
+		int32 GroupEnd = GroupStart;
+		for (; GroupEnd < Order.Num(); GroupEnd++)
+		{
+			const FTargetLockLocker& Locker = Lockers[Order[GroupEnd]];
+			const FBox Extended = GroupBounds + Locker.Owner->GetActorLocation();
+			if (GroupEnd > GroupStart && Extended.GetExtent().GetMax() > MaxRadius) break;
+
+			GroupBounds = Extended;
+			GroupRadius = FMath::Max(GroupRadius, static_cast<double>(Locker.Config->Data.MaxDistanceToStartTargetLock));
+		}
+
+		Overlaps.Reset();
+		Candidates.Reset();
+		SeenCandidates.Reset();
+		//The group bounds grown by the search radius cover every search sphere of the group. A sphere around
+		//the whole group would need up to 2.7 times the search radius.
+		World->OverlapMultiByObjectType(Overlaps, GroupBounds.GetCenter(), FQuat::Identity, ObjectParams,
+			FCollisionShape::MakeBox(GroupBounds.GetExtent() + FVector(GroupRadius)), QueryParams);
+
+		for (const FOverlapResult& Overlap : Overlaps)
+		{
+			AActor* Actor = Overlap.GetActor();
+			if (Actor && !SeenCandidates.Contains(Actor))
+			{
+				SeenCandidates.Add(Actor);
+				Candidates.Add(Actor);
+			}
+		}
+
+		for (int32 i = GroupStart; i < GroupEnd; i++)
+		{
+			const FTargetLockLocker& Locker = Lockers[Order[i]];
+			OutTargets[Order[i]] = UTargetLockUtilities::SelectBestTarget(this, Locker.Config->Data, Locker.Owner,
+				Locker.ViewPoint, Candidates, true, Locker.CurrentTarget);
+		}
+
+		GroupStart = GroupEnd;
+	}
+}
+
+void UTargetLockSubsystem::RequestAcquisition(const FTargetLockLocker& Locker)
+{
+	if (!Locker.Owner || !Locker.Config) return;
+
+	if (const int32* Index = PendingAcquisitionIndices.Find(Locker.Owner.Get()))
+	{
+		PendingAcquisitions[*Index] = Locker;
+		return;
+	}
+	PendingAcquisitionIndices.Add(Locker.Owner.Get(), PendingAcquisitions.Add(Locker));
+}
+
+bool UTargetLockSubsystem::ConsumeAcquisitionResult(const AActor* Owner, AActor*& OutTarget)
+{
+	FAcquisitionResult Result;
+	if (!AcquisitionResults.RemoveAndCopyValue(Owner, Result)) return false;
+
+	OutTarget = Result.Target.Get();
+	return true;
+}
+
+void UTargetLockSubsystem::FlushAcquisitionRequests()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	for (auto It = AcquisitionResults.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value().Time > TargetLockBatch::AcquisitionResultLifetime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	CompleteAsyncAcquisition();
+
+	if (PendingAcquisitions.Num() == 0) return;
+
+	//Lockers searching on a worker thread only get their snapshot taken here. There is only one worker batch at a time,
+	//lockers asking while it runs wait for the next flush.
+	TArray<FTargetLockLocker> AsyncLockers;
+	TArray<FTargetLockLocker> DeferredLockers;
+	for (int32 i = PendingAcquisitions.Num() - 1; i >= 0; i--)
+	{
+		const UTargetLockConfig* Config = PendingAcquisitions[i].Config;
+		if (!Config || !Config->Data.AcquireOnWorkerThread) continue;
+
+		(AsyncAcquisitionBatch ? DeferredLockers : AsyncLockers).Add(PendingAcquisitions[i]);
+		PendingAcquisitions.RemoveAtSwap(i);
+	}
+
+	if (AsyncLockers.Num() > 0)
+	{
+		LaunchAsyncAcquisition(AsyncLockers);
+	}
+
+	if (PendingAcquisitions.Num() > 0)
+	{
+		TArray<AActor*> Targets;
+		FindBestTargetsBatch(PendingAcquisitions, Targets);
+
+		for (int32 i = 0; i < PendingAcquisitions.Num(); i++)
+		{
+			if (const AActor* Owner = PendingAcquisitions[i].Owner)
+			{
+				AcquisitionResults.Add(Owner, { Targets[i], Now });
+			}
+		}
+	}
+
+	PendingAcquisitions.Reset();
+	PendingAcquisitionIndices.Reset();
+
+	for (const FTargetLockLocker& Locker : DeferredLockers)
+	{
+		RequestAcquisition(Locker);
+	}
+}
+
+void UTargetLockSubsystem::LaunchAsyncAcquisition(TArrayView<const FTargetLockLocker> Lockers)
+{
+	TSharedPtr<FTargetLockAsyncAcquisitionBatch, ESPMode::ThreadSafe> Batch = MakeShared<FTargetLockAsyncAcquisitionBatch, ESPMode::ThreadSafe>();
+	Batch->Reserve(Lockers.Num());
+
+	TArray<AActor*> Candidates;
+	for (const FTargetLockLocker& Locker : Lockers)
+	{
+		AActor* Owner = Locker.Owner;
+		if (!IsValid(Owner) || !Locker.Config) continue;
+
+		FTargetLockAsyncAcquisition& Acquisition = Batch->AddDefaulted_GetRef();
+		Acquisition.Config = Locker.Config.Get();
+		SnapshotAcquisition(Acquisition, Locker.Config->Data, Owner, Locker.ViewPoint, Locker.CurrentTarget, Candidates);
+	}
+
+	AsyncAcquisitionBatch = Batch;
+	AsyncAcquisitionTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Batch]()
+	{
+		for (FTargetLockAsyncAcquisition& Acquisition : *Batch)
+		{
+			Acquisition.Score();
+		}
+	});
+}
+
+void UTargetLockSubsystem::SnapshotAcquisition(FTargetLockAsyncAcquisition& Acquisition, const FStruct_TargetLockData& Data,
+	AActor* Owner, const FTargetLockViewPoint& ViewPoint, const AActor* CurrentTarget, TArray<AActor*>& Candidates)
+{
+	Acquisition.Owner = Owner;
+	Acquisition.ViewPoint = ViewPoint;
+	Acquisition.MaxDistance = Data.MaxDistanceToStartTargetLock;
+	Acquisition.MaxAngle = Data.MaxAngleToTarget;
+	Acquisition.bCullToViewFrustum = Data.CullToViewFrustum;
+	Acquisition.ViewFrustumInset = Data.ViewFrustumInset;
+	Acquisition.bUseWeightedScoring = Data.UseWeightedScoring;
+	Acquisition.Scoring = Data.Scoring;
+	if (Acquisition.bUseWeightedScoring && !Acquisition.Scoring.IsBaked())
+	{
+		//Configs that never went through PostLoad, e.g. created at runtime. The worker must not evaluate the curves.
+		Acquisition.Scoring.Bake();
+	}
+
+	Candidates.Reset();
+	UTargetLockUtilities::GatherCandidates(this, Data, Owner->GetActorLocation(), Data.MaxDistanceToStartTargetLock, Candidates);
+
+	//Same hint as UTargetLockUtilities::SelectBestTargets, only for the view that actually gets rendered
+	const bool bUseRenderHint = Data.DoLineOfSightCheck && Data.SkipCandidatesNotRecentlyRendered &&
+		UTargetLockUtilities::IsRenderedFromLockerView(Owner);
+	FTargetLockDebugStats* Stats = bUseRenderHint ? GetDebugStats() : nullptr;
+
+	//Everything that needs the candidate objects runs here, the worker only gets the copied values
+	const int32 TagQueryId = ResolveTargetTagQueryId(Data);
+	for (AActor* Candidate : Candidates)
+	{
+		if (!Candidate || Candidate == Owner) continue;
+		if (UTargetLockUtilities::HasUntargetableTag(Data, Candidate) || !MatchesTargetTagQuery(TagQueryId, Candidate)) continue;
+
+		if (bUseRenderHint && !Candidate->WasRecentlyRendered())
+		{
+			if (Stats)
+			{
+				Stats->Current.SkippedTraces++;
+			}
+			continue;
+		}
+
+		float Threat = 0;
+		float Damaged = 0;
+		if (Data.UseWeightedScoring && Candidate->Implements<UTargetLockTargetInterface>())
+		{
+			Threat = ITargetLockTargetInterface::Execute_GetTargetLockThreat(Candidate, Owner);
+
+			const float TimeSinceDamaged = ITargetLockTargetInterface::Execute_GetTargetLockTimeSinceDamaged(Candidate, Owner);
+			if (TimeSinceDamaged >= 0 && Data.Scoring.LastDamagedWindow > 0)
+			{
+				Damaged = 1 - TimeSinceDamaged / Data.Scoring.LastDamagedWindow;
+			}
+		}
+
+		if (Candidate == CurrentTarget)
+		{
+			Acquisition.CurrentIndex = Acquisition.Candidates.Num();
+		}
+		Acquisition.Candidates.Add(Candidate);
+		Acquisition.Locations.Add(Candidate->GetActorLocation());
+		Acquisition.Threats.Add(Threat);
+		Acquisition.DamagedAlphas.Add(Damaged);
+	}
+}
+
+void UTargetLockSubsystem::CompleteAsyncAcquisition()
+{
+	if (!AsyncAcquisitionBatch || !AsyncAcquisitionTask.IsCompleted()) return;
+
+	const TSharedPtr<FTargetLockAsyncAcquisitionBatch, ESPMode::ThreadSafe> Batch = MoveTemp(AsyncAcquisitionBatch);
+	AsyncAcquisitionBatch.Reset();
+
+	UWorld* World = GetWorld();
+	FTargetLockDebugStats* Stats = GetDebugStats();
+	for (const FTargetLockAsyncAcquisition& Acquisition : *Batch)
+	{
+		const UTargetLockConfig* Config = Acquisition.Config.Get();
+		AActor* Owner = Acquisition.Owner.ResolveObjectPtr();
+		if (!Config || !Owner) continue;
+
+		const FStruct_TargetLockData& Data = Config->Data;
+		if (!Data.DoLineOfSightCheck)
+		{
+			//Candidates may have gone away while the worker was scoring, the best one still around wins
+			AActor* Target = nullptr;
+			for (const int32 Index : Acquisition.Order)
+			{
+				Target = Acquisition.Candidates[Index].Get();
+				if (Target) break;
+			}
+			FinishAsyncAcquisition(Acquisition.Owner, Target);
+			continue;
+		}
+
+		const uint32 RequestId = NextAsyncLineOfSightRequestId++;
+		FAsyncLineOfSightRequest& Request = AsyncLineOfSightRequests.Add(RequestId);
+		Request.Owner = Acquisition.Owner;
+
+		const FTraceDelegate TraceDelegate = FTraceDelegate::CreateUObject(this, &UTargetLockSubsystem::OnAsyncLineOfSightTraceDone);
+		const FTargetLockLineOfSightParams& TraceParams = Data.LineOfSightTrace;
+		for (const int32 Index : Acquisition.Order)
+		{
+			AActor* Candidate = Acquisition.Candidates[Index].Get();
+			if (!Candidate) continue;
+
+			const uint32 Slot = Request.Candidates.Add(Candidate);
+
+			//No trace needed for targets the visibility provider vouches for, nothing behind them has to be traced either
+			if (Data.VisibilityProvider && Data.VisibilityProvider->IsConfirmedVisible(Acquisition.ViewPoint, Owner, Candidate))
+			{
+				Request.Results.Add(TargetLockBatch::Clear);
+				if (Stats)
+				{
+					Stats->Current.SkippedTraces++;
+				}
+				break;
+			}
+
+			//Hidden behind the level, no trace needed to know
+			if (Data.UseStaticVisibilityCache && IsStaticallyBlocked(Acquisition.ViewPoint.Location, Candidate->GetActorLocation(), 0))
+			{
+				Request.Results.Add(TargetLockBatch::Blocked);
+				if (Stats)
+				{
+					Stats->Current.SkippedTraces++;
+				}
+				continue;
+			}
+			Request.Results.Add(TargetLockBatch::Pending);
+
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TargetLockAsyncLineOfSight), TraceParams.TraceComplex);
+			QueryParams.AddIgnoredActor(Owner);
+			QueryParams.AddIgnoredActor(Candidate);
+
+			const FVector Start = Acquisition.ViewPoint.Location;
+			const FVector End = Candidate->GetActorLocation();
+			const uint32 UserData = RequestId * TargetLockBatch::MaxAsyncLineOfSightCandidates + Slot;
+			if (!TraceParams.TraceProfile.IsNone())
+			{
+				World->AsyncLineTraceByProfile(EAsyncTraceType::Single, Start, End, TraceParams.TraceProfile, QueryParams, &TraceDelegate, UserData);
+			}
+			else
+			{
+				World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, TraceParams.TraceChannel, QueryParams,
+					FCollisionResponseParams::DefaultResponseParam, &TraceDelegate, UserData);
+			}
+
+			if (Request.Candidates.Num() == TargetLockBatch::MaxAsyncLineOfSightCandidates) break;
+		}
+
+		//Nothing to trace or the best candidate got vouched for
+		ResolveAsyncLineOfSight(RequestId);
+	}
+}
+
+void UTargetLockSubsystem::OnAsyncLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	const uint32 RequestId = TraceDatum.UserData / TargetLockBatch::MaxAsyncLineOfSightCandidates;
+	const int32 Slot = TraceDatum.UserData % TargetLockBatch::MaxAsyncLineOfSightCandidates;
+
+	FAsyncLineOfSightRequest* Request = AsyncLineOfSightRequests.Find(RequestId);
+	if (!Request || !Request->Results.IsValidIndex(Slot)) return;
+
+	const bool bBlocked = TraceDatum.OutHits.Num() > 0 && TraceDatum.OutHits[0].bBlockingHit;
+	Request->Results[Slot] = bBlocked ? TargetLockBatch::Blocked : TargetLockBatch::Clear;
+
+	if (FTargetLockDebugStats* Stats = GetDebugStats())
+	{
+		Stats->AddRay(TraceDatum.Start, TraceDatum.End, bBlocked);
+	}
+
+	ResolveAsyncLineOfSight(RequestId);
+}
+
+void UTargetLockSubsystem::ResolveAsyncLineOfSight(uint32 RequestId)
+{
+	const FAsyncLineOfSightRequest* Request = AsyncLineOfSightRequests.Find(RequestId);
+	if (!Request) return;
+
+	//The best candidate with a clear trace wins, but only once every better candidate is known to be blocked
+	AActor* Target = nullptr;
+	for (int32 i = 0; i < Request->Results.Num(); i++)
+	{
+		if (Request->Results[i] == TargetLockBatch::Pending) return;
+		if (Request->Results[i] == TargetLockBatch::Clear)
+		{
+			Target = Request->Candidates[i].Get();
+			break;
+		}
+	}
+
+	const TObjectKey<AActor> Owner = Request->Owner;
+	AsyncLineOfSightRequests.Remove(RequestId);
+	FinishAsyncAcquisition(Owner, Target);
+}
+
+void UTargetLockSubsystem::FinishAsyncAcquisition(const TObjectKey<AActor>& Owner, AActor* Target)
+{
+	AActor* OwnerActor = Owner.ResolveObjectPtr();
+	if (!OwnerActor) return;
+
+	AcquisitionResults.Add(Owner, { Target, GetWorld()->GetTimeSeconds() });
+	OnAsyncAcquisitionComplete.Broadcast(OwnerActor, Target);
+}
+
+TArray<FGameplayTagQuery> UTargetLockSubsystem::TargetTagQueries;
+uint32 UTargetLockSubsystem::TargetTagQueryGeneration = 1;
+int32 UTargetLockSubsystem::NumSubsystems = 0;
+
+int32 UTargetLockSubsystem::RegisterTargetTagQuery(const FGameplayTagQuery& Query)
+{
+	if (Query.IsEmpty()) return INDEX_NONE;
+
+	const int32 Existing = TargetTagQueries.IndexOfByKey(Query);
+	return Existing != INDEX_NONE ? Existing : TargetTagQueries.Add(Query);
+}
+
+void UTargetLockSubsystem::CacheTargetTagQueryId(FStruct_TargetLockData& Data)
+{
+	Data.TargetTagQueryId = RegisterTargetTagQuery(Data.TargetTagQuery);
+	Data.TargetTagQueryGeneration = TargetTagQueryGeneration;
+}
+
+int32 UTargetLockSubsystem::ResolveTargetTagQueryId(const FStruct_TargetLockData& Data)
+{
+	if (Data.TargetTagQueryGeneration == TargetTagQueryGeneration) return Data.TargetTagQueryId;
+
+	return RegisterTargetTagQuery(Data.TargetTagQuery);
+}
+
+bool UTargetLockSubsystem::MatchesTargetTagQuery(int32 QueryId, const AActor* Target)
+{
+	if (!TargetTagQueries.IsValidIndex(QueryId)) return true;
+	if (!Target) return false;
+
+	FTargetTagQueryCacheEntry* Entry = TargetTagQueryCache.Find(Target);
+	if (!Entry)
+	{
+		Entry = &TargetTagQueryCache.Add(Target);
+
+		//Any tag change of the target may change the result of any query, so all of its results get invalidated
+		if (UAbilitySystemComponent* AbilitySystem = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Target))
+		{
+			Entry->AbilitySystem = AbilitySystem;
+			Entry->TagChangedHandle = AbilitySystem->RegisterGenericGameplayTagEvent().AddUObject(this,
+				&UTargetLockSubsystem::OnCachedTargetTagChanged, TObjectKey<AActor>(Target));
+		}
+	}
+
+	if (Entry->Results.Num() <= QueryId)
+	{
+		Entry->Results.SetNumZeroed(TargetTagQueries.Num());
+	}
+
+	if (Entry->Results[QueryId] == 0)
+	{
+		FGameplayTagContainer OwnedTags;
+		if (const UAbilitySystemComponent* AbilitySystem = Entry->AbilitySystem.Get())
+		{
+			AbilitySystem->GetOwnedGameplayTags(OwnedTags);
+		}
+		Entry->Results[QueryId] = TargetTagQueries[QueryId].Matches(OwnedTags) ? 1 : 2;
+	}
+
+	return Entry->Results[QueryId] == 1;
+}
+
+void UTargetLockSubsystem::OnCachedTargetTagChanged(const FGameplayTag Tag, int32 NewCount, TObjectKey<AActor> Target)
+{
+	if (FTargetTagQueryCacheEntry* Entry = TargetTagQueryCache.Find(Target))
+	{
+		FMemory::Memzero(Entry->Results.GetData(), Entry->Results.Num());
+	}
+}
+
+void UTargetLockSubsystem::PruneTargetTagQueryCache()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastTagQueryCachePruneTime < TargetLockBatch::TagQueryCachePruneInterval) return;
+	LastTagQueryCachePruneTime = Now;
+
+	for (auto It = TargetTagQueryCache.CreateIterator(); It; ++It)
+	{
+		if (It.Key().ResolveObjectPtr()) continue;
+
+		if (UAbilitySystemComponent* AbilitySystem = It.Value().AbilitySystem.Get())
+		{
+			AbilitySystem->RegisterGenericGameplayTagEvent().Remove(It.Value().TagChangedHandle);
+		}
+		It.RemoveCurrent();
+	}
+}
+
+void UTargetLockSubsystem::GatherIndexedCandidates(const FStruct_TargetLockData& Config, const FVector& Origin, float Radius,
+	TArray<AActor*>& OutCandidates)
+{
+	for (const TSubclassOf<AActor>& LockClass : Config.LockableClasses)
+	{
+		RegisterIndexedClass(LockClass);
+	}
+
+	if (CandidateIndex.IsStale())
+	{
+		CandidateIndex.Rebuild();
+	}
+
+	const int32 FirstCandidate = OutCandidates.Num();
+	CandidateIndex.Query(Origin, Radius, OutCandidates);
+
+	//The index holds the actors of every config's classes
+	for (int32 i = OutCandidates.Num() - 1; i >= FirstCandidate; i--)
+	{
+		if (!UTargetLockUtilities::IsLockableClass(Config, OutCandidates[i]))
+		{
+			OutCandidates.RemoveAtSwap(i, 1, false);
+		}
+	}
+}
+
+void UTargetLockSubsystem::RegisterIndexedClass(TSubclassOf<AActor> ActorClass)
+{
+	if (!ActorClass) return;
+
+	//Subclasses of an indexed class are already tracked
+	for (const UClass* IndexedClass : IndexedClasses)
+	{
+		if (ActorClass->IsChildOf(IndexedClass)) return;
+	}
+	IndexedClasses.Add(ActorClass);
+
+	for (TActorIterator<AActor> It(GetWorld(), ActorClass); It; ++It)
+	{
+		CandidateIndex.Add(*It);
+	}
+
+	//The search that registered the class expects its actors right away, not from the next frame on
+	CandidateIndex.Rebuild();
+}
+
+bool UTargetLockSubsystem::IsIndexedActor(const AActor* Actor) const
+{
+	for (const UClass* IndexedClass : IndexedClasses)
+	{
+		if (Actor->IsA(IndexedClass)) return true;
+	}
+	return false;
+}
+
+void UTargetLockSubsystem::OnLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld() || IndexedClasses.Num() == 0) return;
+
+	CandidateIndex.AddLevel(Level, [this](const AActor* Actor) { return IsIndexedActor(Actor); });
+}
+
+void UTargetLockSubsystem::OnLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+	//A null level means the whole world gets cleaned up
+	if (World != GetWorld()) return;
+
+	if (Level)
+	{
+		CandidateIndex.RemoveLevel(Level);
+	}
+	else
+	{
+		CandidateIndex.Reset();
+	}
+}
+
+void UTargetLockSubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (Actor && IndexedClasses.Num() > 0 && IsIndexedActor(Actor))
+	{
+		CandidateIndex.Add(Actor);
+	}
+}
+
+void UTargetLockSubsystem::OnActorDestroyed(AActor* Actor)
+{
+	CandidateIndex.Remove(Actor);
+}
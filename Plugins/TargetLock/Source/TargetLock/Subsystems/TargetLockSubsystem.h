@@ -0,0 +1,436 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "TargetLock/Data/TargetLockData.h"
+#include "TargetLock/Data/TargetLockTagEventBinding.h"
+#include "TargetLock/Subsystems/TargetLockCandidateIndex.h"
+#include "TargetLock/Debug/TargetLockDebugStats.h"
+#include "TargetLock/Subsystems/TargetLockAsyncAcquisition.h"
+#include "Tasks/Task.h"
+#include "TargetLockSubsystem.generated.h"
+
+class ATargetLockIndicatorRenderer;
+class UCameraComponent;
+class UAbilitySystemComponent;
+class UStaticMesh;
+class UTargetLockConfig;
+class ITargetLockEntitySource;
+class ATargetLockVisibilityVolume;
+struct FTraceHandle;
+struct FTraceDatum;
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnSubsystemTargetLockEnded, FTargetLockHandle);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnTargetLockAsyncAcquired, AActor* /*Owner*/, AActor* /*Target*/);
+
+//Free visualize actors of a single class, waiting to be handed out again
+USTRUCT()
+struct TARGETLOCK_API FTargetLockVisualizeActorPool
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> FreeActors;
+};
+
+//All lock indicators drawn with the same mesh. The arrays are parallel, one entry per indicator.
+USTRUCT()
+struct TARGETLOCK_API FTargetLockIndicatorBatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<UStaticMesh> Mesh;
+
+	UPROPERTY()
+	TObjectPtr<ATargetLockIndicatorRenderer> Renderer;
+
+	TArray<int32> IndicatorIds;
+	TArray<FTargetLockTargetHandle> Targets;
+	TArray<FVector> Offsets;
+	TArray<float> Scales;
+
+	//Reused every tick to avoid reallocating the transform buffer
+	TArray<FTransform> Transforms;
+};
+
+//State of a lock that is run by the subsystem instead of an ability task
+USTRUCT()
+struct TARGETLOCK_API FTargetLockActiveLock
+{
+	GENERATED_BODY()
+
+	FTargetLockHandle Handle;
+
+	//Key into LocksByOwner, stays valid even after the owner got destroyed
+	TObjectKey<AActor> OwnerKey;
+
+	TWeakObjectPtr<AActor> Owner;
+	TWeakObjectPtr<UCameraComponent> Camera;
+	FTargetLockTargetHandle Target;
+
+	UPROPERTY()
+	TObjectPtr<UTargetLockConfig> Config;
+
+	UPROPERTY()
+	TObjectPtr<AActor> VisualizeActor;
+
+	int32 IndicatorId = INDEX_NONE;
+
+	//How long the target has been out of range, angle or sight, see UTargetLockUtilities::UpdateLockBreakTimer
+	float BreakTimer = 0;
+
+	FTargetLockTagEventBinding TargetTagEvents;
+	FDelegateHandle TargetTransformUpdatedHandle;
+};
+
+/**
+ * World wide bookkeeping for target locking.
+ * Holds a pool of visualize actors so locking onto a target doesn't have to spawn and destroy an actor every time.
+ * Lightweight lock indicators are drawn through one instanced static mesh per indicator mesh, so showing
+ * many indicators costs about the same as showing one.
+ * Locks started through StartLock are run here as well, so their owners only have to keep a handle around.
+ */
+UCLASS()
+class TARGETLOCK_API UTargetLockSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Takes a visualize actor out of the pool, shows it and attaches it to the given target.
+	 * A new actor only gets spawned if the pool for this class is empty.
+	 *
+	 * @param VisualizeActorClass The class of the visualize actor.
+	 * @param AttachTo The actor the visualize actor gets attached to.
+	 * @return The visualize actor or nullptr if the class is not set.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Target Lock | Visualization")
+	AActor* AcquireVisualizeActor(TSubclassOf<AActor> VisualizeActorClass, AActor* AttachTo);
+
+	//Detaches and hides the visualize actor and puts it back into the pool. Does nothing for nullptr.
+	UFUNCTION(BlueprintCallable, Category = "Target Lock | Visualization")
+	void ReleaseVisualizeActor(AActor* VisualizeActor);
+
+	//Spawns visualize actors ahead of time, so not even the first lock has to spawn one.
+	UFUNCTION(BlueprintCallable, Category = "Target Lock | Visualization")
+	void PrewarmVisualizeActors(TSubclassOf<AActor> VisualizeActorClass, int32 Count);
+
+	/**
+	 * Starts drawing a lock indicator on the given target. All indicators sharing a mesh are drawn by one instanced
+	 * static mesh component and their transforms get updated in bulk every frame.
+	 *
+	 * @param Mesh The mesh to draw the indicator with.
+	 * @param Target The actor the indicator follows.
+	 * @param Offset World space offset from the target location.
+	 * @param Scale Uniform scale of the indicator.
+	 * @return Id of the indicator, needed to remove it again. INDEX_NONE if mesh or target are not valid.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Target Lock | Visualization")
+	int32 AddLockIndicator(UStaticMesh* Mesh, AActor* Target, FVector Offset = FVector::ZeroVector, float Scale = 1);
+
+	//Same as AddLockIndicator, but the target may also be an entity of the entity source
+	int32 AddLockIndicatorForTarget(UStaticMesh* Mesh, const FTargetLockTargetHandle& Target, FVector Offset = FVector::ZeroVector, float Scale = 1);
+
+	//Stops drawing the indicator with the given id. Does nothing for INDEX_NONE or unknown ids.
+	UFUNCTION(BlueprintCallable, Category = "Target Lock | Visualization")
+	void RemoveLockIndicator(int32 IndicatorId);
+
+	//Number of lock indicators currently drawn, across all meshes
+	UFUNCTION(BlueprintPure, Category = "Target Lock | Visualization")
+	int32 GetLockIndicatorCount() const { return IndicatorLookup.Num(); }
+
+	/**
+	 * Searches a target for the owner and keeps it locked on until StopLock is called or the lock breaks.
+	 *
+	 * @param Owner The actor locking on. Its controller gets rotated towards the target.
+	 * @param Config The shared configuration of the lock.
+	 * @param OptionalCamera Optional: The camera to lock with. Gets searched on the owner if not given.
+	 * @return Handle of the lock, invalid if no target was found.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Target Lock")
+	FTargetLockHandle StartLock(AActor* Owner, UTargetLockConfig* Config, UCameraComponent* OptionalCamera = nullptr);
+
+	UFUNCTION(BlueprintCallable, Category = "Target Lock")
+	void StopLock(FTargetLockHandle Handle);
+
+	//The lock the given actor currently runs through the subsystem, invalid handle if there is none
+	UFUNCTION(BlueprintPure, Category = "Target Lock")
+	FTargetLockHandle FindLockByOwner(const AActor* Owner) const;
+
+	//The actor the lock is locked onto, nullptr if it is locked onto an entity
+	UFUNCTION(BlueprintPure, Category = "Target Lock")
+	AActor* GetLockTarget(FTargetLockHandle Handle) const;
+
+	UFUNCTION(BlueprintPure, Category = "Target Lock")
+	FTargetLockTargetHandle GetLockTargetHandle(FTargetLockHandle Handle) const;
+
+	/**
+	 * Sets the source of lock targets that are not actors. There is only one, setting another one replaces it.
+	 * The source has to call this again with nullptr before it goes away.
+	 */
+	void SetEntitySource(ITargetLockEntitySource* Source);
+
+	//Location of an actor or entity target. False if the target is gone.
+	bool GetTargetLocation(const FTargetLockTargetHandle& Target, FVector& OutLocation) const;
+
+	/**
+	 * Like UTargetLockUtilities::FindBestTargetFromViewPoint, but also considers the entities of the entity source
+	 * if the config asks for it. Entities get the same range, view and scoring checks as actors, with no threat and
+	 * damage. They own no tags, so they are only lockable if the TargetTagQuery accepts a target without tags, and
+	 * their Line of Sight is always traced because the visibility provider only knows actors.
+	 */
+	FTargetLockTargetHandle FindBestTargetHandle(const FStruct_TargetLockData& Config, AActor* Owner, const FTargetLockViewPoint& ViewPoint);
+
+	UFUNCTION(BlueprintPure, Category = "Target Lock")
+	bool IsLockActive(FTargetLockHandle Handle) const { return LockIndices.Contains(Handle.Id); }
+
+	/**
+	 * Finds the best target for many lockers at once. Lockers are sorted spatially and grouped, every group gathers
+	 * its candidates with a single overlap which all lockers of the group then score against.
+	 *
+	 * @param Lockers The lockers to find targets for.
+	 * @param OutTargets One entry per locker, nullptr where no target was found.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Target Lock")
+	void FindBestTargetsBatch(const TArray<FTargetLockLocker>& Lockers, TArray<AActor*>& OutTargets);
+
+	/**
+	 * Queues a target search that gets resolved together with all other queued searches in one FindBestTargetsBatch
+	 * during the next subsystem tick. Requesting again for the same owner before that only updates the request.
+	 */
+	void RequestAcquisition(const FTargetLockLocker& Locker);
+
+	/**
+	 * Takes the result of a RequestAcquisition for the given owner.
+	 *
+	 * @param OutTarget The found target, may be nullptr if the search found nothing.
+	 * @return False if there is no result (yet).
+	 */
+	bool ConsumeAcquisitionResult(const AActor* Owner, AActor*& OutTarget);
+
+	/**
+	 * Registers a target tag query, equal queries share one id. The ids are shared by all worlds and stay valid
+	 * until the last game world is torn down, which empties the registry. Game thread only.
+	 */
+	static int32 RegisterTargetTagQuery(const FGameplayTagQuery& Query);
+
+	//Registers the TargetTagQuery of the data and stores its id in it, so searches don't have to look it up
+	static void CacheTargetTagQueryId(FStruct_TargetLockData& Data);
+
+	//Id of the TargetTagQuery of the data. Registers the query again if the stored id is from before the registry got emptied.
+	static int32 ResolveTargetTagQueryId(const FStruct_TargetLockData& Data);
+
+	/**
+	 * True if the owned tags of the target match the registered query. The result is cached per target and
+	 * query until the tags of the target's ability system component change.
+	 */
+	bool MatchesTargetTagQuery(int32 QueryId, const AActor* Target);
+
+	/**
+	 * Appends the actors of the candidate index within the radius that are of one of the lockable classes of the config.
+	 * Lockable classes get added to the index the first time they are asked for.
+	 */
+	void GatherIndexedCandidates(const FStruct_TargetLockData& Config, const FVector& Origin, float Radius, TArray<AActor*>& OutCandidates);
+
+	//Actors of this class are tracked by the candidate index from now on, including the ones already in the world
+	UFUNCTION(BlueprintCallable, Category = "Target Lock")
+	void RegisterIndexedClass(TSubclassOf<AActor> ActorClass);
+
+	//Number of locks run by the subsystem
+	int32 GetActiveLockCount() const { return ActiveLocks.Num(); }
+
+	//Called by the visibility volumes with baked data when they begin and end play
+	void RegisterVisibilityVolume(ATargetLockVisibilityVolume* Volume);
+	void UnregisterVisibilityVolume(ATargetLockVisibilityVolume* Volume);
+
+	/**
+	 * True if a baked visibility volume knows that static geometry blocks every trace between the two boxes.
+	 * False means unknown, the traces decide then.
+	 *
+	 * @param Margin Half size of the boxes around From and To, how far the traces may start or end away from them.
+	 */
+	bool IsStaticallyBlocked(const FVector& From, const FVector& To, float Margin) const;
+
+	/**
+	 * Collects FTargetLockDebugStats for the next second. Called by the gameplay debugger every time it gathers its data,
+	 * so collecting stops on its own once the debugger is closed.
+	 *
+	 * @param FocusActor The actor whose searches get their score breakdown recorded.
+	 */
+	void RequestDebugStats(const AActor* FocusActor);
+
+	//nullptr unless the stats got requested recently
+	FTargetLockDebugStats* GetDebugStats();
+
+	//Broadcast when a lock run by the subsystem ended, no matter if it was stopped or broke on its own
+	FOnSubsystemTargetLockEnded OnLockEnded;
+
+	//Broadcast on the game thread when a search that ran on a worker thread (see AcquireOnWorkerThread) is done.
+	//The result can be taken with ConsumeAcquisitionResult as well.
+	FOnTargetLockAsyncAcquired OnAsyncAcquisitionComplete;
+
+protected:
+	void FlushAcquisitionRequests();
+
+	//Takes the snapshots of the lockers on the game thread and scores them in a worker task
+	void LaunchAsyncAcquisition(TArrayView<const FTargetLockLocker> Lockers);
+
+	//Copies the config values and the actor candidates that pass the checks needing their objects into the snapshot
+	void SnapshotAcquisition(FTargetLockAsyncAcquisition& Acquisition, const FStruct_TargetLockData& Data, AActor* Owner,
+		const FTargetLockViewPoint& ViewPoint, const AActor* CurrentTarget, TArray<AActor*>& Candidates);
+
+	//Picks up the results of the worker task once it is done and starts the async Line of Sight traces
+	void CompleteAsyncAcquisition();
+
+	void OnAsyncLineOfSightTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	//Finishes the search once the best candidate whose trace came back clear is known
+	void ResolveAsyncLineOfSight(uint32 RequestId);
+
+	void FinishAsyncAcquisition(const TObjectKey<AActor>& Owner, AActor* Target);
+
+	void UpdateActiveLocks(float DeltaTime);
+
+	//Returns false if the lock broke and has to be removed
+	bool UpdateActiveLock(FTargetLockActiveLock& Lock, float DeltaTime);
+
+	void RemoveActiveLockAt(int32 Index);
+
+	//Lock targets get watched for the events that make them invalid, so locks break right when these happen
+	void BindLockTargetEvents(FTargetLockActiveLock& Lock);
+	void UnbindLockTargetEvents(FTargetLockActiveLock& Lock);
+
+	void StopLocksOnTarget(const AActor* Target);
+
+	UFUNCTION()
+	void OnLockTargetDestroyed(AActor* DestroyedActor);
+
+	UFUNCTION()
+	void OnLockTargetEndPlay(AActor* Actor, EEndPlayReason::Type EndPlayReason);
+
+	void OnLockTargetTagChanged(const FGameplayTag Tag, int32 NewCount, FTargetLockHandle Handle);
+
+	void OnLockTargetTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, FTargetLockHandle Handle);
+
+	void UpdateLockIndicators();
+
+	bool IsIndexedActor(const AActor* Actor) const;
+
+	void OnLevelAddedToWorld(ULevel* Level, UWorld* World);
+	void OnLevelRemovedFromWorld(ULevel* Level, UWorld* World);
+	void OnActorSpawned(AActor* Actor);
+	void OnActorDestroyed(AActor* Actor);
+
+	void OnCachedTargetTagChanged(const FGameplayTag Tag, int32 NewCount, TObjectKey<AActor> Target);
+
+	//Drops the cached tag query results of targets that are gone
+	void PruneTargetTagQueryCache();
+
+	FTargetLockIndicatorBatch* FindOrAddIndicatorBatch(UStaticMesh* Mesh);
+
+	AActor* SpawnPooledVisualizeActor(UClass* VisualizeActorClass);
+
+	static void SetVisualizeActorActive(AActor* VisualizeActor, bool bActive);
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FTargetLockVisualizeActorPool> VisualizeActorPools;
+
+	UPROPERTY()
+	TArray<FTargetLockIndicatorBatch> IndicatorBatches;
+
+	//Indicator id -> batch index and slot inside that batch
+	TMap<int32, TPair<int32, int32>> IndicatorLookup;
+
+	int32 NextIndicatorId = 0;
+
+	UPROPERTY()
+	TArray<FTargetLockActiveLock> ActiveLocks;
+
+	//Lock id -> index in ActiveLocks
+	TMap<int32, int32> LockIndices;
+
+	TMap<TObjectKey<AActor>, FTargetLockHandle> LocksByOwner;
+
+	//How many locks listen to OnDestroyed/OnEndPlay of a target, the dynamic delegates are only bound once per target
+	TMap<TObjectKey<AActor>, int32> BoundTargetCounts;
+
+	int32 NextLockId = 0;
+
+	UPROPERTY()
+	TArray<FTargetLockLocker> PendingAcquisitions;
+
+	//Owner -> index in PendingAcquisitions
+	TMap<TObjectKey<AActor>, int32> PendingAcquisitionIndices;
+
+	struct FAcquisitionResult
+	{
+		TWeakObjectPtr<AActor> Target;
+		double Time = 0;
+	};
+	TMap<TObjectKey<AActor>, FAcquisitionResult> AcquisitionResults;
+
+	//Registered target tag queries of all worlds, the index is the query id
+	static TArray<FGameplayTagQuery> TargetTagQueries;
+
+	//Counts up every time TargetTagQueries gets emptied, ids stored with an older generation are stale
+	static uint32 TargetTagQueryGeneration;
+
+	//Subsystems alive in all worlds, the last one to go empties TargetTagQueries
+	static int32 NumSubsystems;
+
+	struct FTargetTagQueryCacheEntry
+	{
+		TWeakObjectPtr<UAbilitySystemComponent> AbilitySystem;
+		FDelegateHandle TagChangedHandle;
+
+		//One entry per query id: 0 = not evaluated yet, 1 = matches, 2 = doesn't match
+		TArray<uint8> Results;
+	};
+	TMap<TObjectKey<AActor>, FTargetTagQueryCacheEntry> TargetTagQueryCache;
+
+	double LastTagQueryCachePruneTime = 0;
+
+	TArray<TWeakObjectPtr<ATargetLockVisibilityVolume>> VisibilityVolumes;
+
+	//The batch the worker task scores. Only touched by the game thread once the task completed.
+	TSharedPtr<FTargetLockAsyncAcquisitionBatch, ESPMode::ThreadSafe> AsyncAcquisitionBatch;
+	UE::Tasks::TTask<void> AsyncAcquisitionTask;
+
+	//A worker search waiting for the async Line of Sight traces of its best candidates
+	struct FAsyncLineOfSightRequest
+	{
+		TObjectKey<AActor> Owner;
+
+		//Best first, parallel to Results
+		TArray<TWeakObjectPtr<AActor>> Candidates;
+
+		//0 = trace pending, 1 = clear, 2 = blocked
+		TArray<uint8> Results;
+	};
+	TMap<uint32, FAsyncLineOfSightRequest> AsyncLineOfSightRequests;
+	uint32 NextAsyncLineOfSightRequestId = 0;
+
+	//Classes whose actors are tracked by the CandidateIndex
+	UPROPERTY()
+	TArray<TObjectPtr<UClass>> IndexedClasses;
+
+	FTargetLockCandidateIndex CandidateIndex;
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+
+	ITargetLockEntitySource* EntitySource = nullptr;
+
+	FTargetLockDebugStats DebugStats;
+	double DebugStatsRequestTime = -1;
+};
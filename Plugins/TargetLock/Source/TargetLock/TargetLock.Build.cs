@@ -26,6 +26,8 @@ public class TargetLock : ModuleRules
 			new string[]
 			{
 				"Core",
+				"GameplayAbilities",
+				"GameplayTags",
 				// ... add other public dependencies that you statically link with here ...
 			}
 			);
@@ -36,16 +38,18 @@ public class TargetLock : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"AIModule",
 				"Slate",
 				"SlateCore",
-				"GameplayAbilities",
-				"GameplayTasks",
-				"GameplayTags"
+				"GameplayTasks"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
 		
 		
+		//Adds the GameplayDebugger module and WITH_GAMEPLAY_DEBUGGER, for the TargetLock category
+		SetupGameplayDebuggerSupport(Target);
+
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]
 			{
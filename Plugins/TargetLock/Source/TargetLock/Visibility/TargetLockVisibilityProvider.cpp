@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Visibility/TargetLockVisibilityProvider.h"
+#include "TargetLockUtilities.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+
+bool UTargetLockRenderVisibilityProvider::IsConfirmedVisible(const FTargetLockViewPoint& ViewPoint, const AActor* OwningActor,
+	const AActor* Target) const
+{
+	//What got rendered was seen by the local player's camera, not by AI or remote players
+	if (!Target || !UTargetLockUtilities::IsRenderedFromLockerView(OwningActor)) return false;
+
+	const UWorld* World = Target->GetWorld();
+	if (!World) return false;
+
+	const double MinRenderTime = World->GetTimeSeconds() - RecentlyRenderedTolerance;
+	bool bRendered = false;
+	Target->ForEachComponent<UPrimitiveComponent>(false, [&bRendered, MinRenderTime](const UPrimitiveComponent* Primitive)
+	{
+		bRendered |= Primitive->IsVisible() && Primitive->GetLastRenderTimeOnScreen() >= MinRenderTime;
+	});
+	return bRendered;
+}
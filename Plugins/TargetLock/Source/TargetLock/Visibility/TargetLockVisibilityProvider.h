@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "TargetLock/Data/TargetLockData.h"
+#include "TargetLockVisibilityProvider.generated.h"
+
+/**
+ * Answers "is this target visible" without physics where it can, so the Line of Sight traces only have to run
+ * for targets it can't vouch for. Set on the lock config, see FStruct_TargetLockData::VisibilityProvider.
+ */
+UCLASS(Abstract, EditInlineNew, DefaultToInstanced, CollapseCategories)
+class TARGETLOCK_API UTargetLockVisibilityProvider : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @param ViewPoint Where the locker looks from.
+	 * @param OwningActor The actor locking on.
+	 * @param Target The target to check.
+	 * @return True if the target is known to be visible. False means unknown, the traces decide then.
+	 */
+	virtual bool IsConfirmedVisible(const FTargetLockViewPoint& ViewPoint, const AActor* OwningActor, const AActor* Target) const
+	{
+		return false;
+	}
+};
+
+/**
+ * Uses the occlusion results of the renderer: targets whose primitives were drawn on screen within the last frames
+ * passed occlusion culling and count as visible. Only for locks of locally controlled players, the renderer only
+ * knows about their view. Dedicated servers have no renderer and always fall back to the traces.
+ */
+UCLASS(meta = (DisplayName = "Render Visibility"))
+class TARGETLOCK_API UTargetLockRenderVisibilityProvider : public UTargetLockVisibilityProvider
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool IsConfirmedVisible(const FTargetLockViewPoint& ViewPoint, const AActor* OwningActor, const AActor* Target) const override;
+
+	//How long ago a primitive of the target may have been on screen to count as visible
+	UPROPERTY(EditAnywhere, meta = (Units = "s", ClampMin = "0"), Category = "Target Lock")
+	float RecentlyRenderedTolerance = 0.1f;
+};
@@ -0,0 +1,276 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Visibility/TargetLockVisibilityVolume.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "Components/BrushComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/World.h"
+#include "Misc/ScopedSlowTask.h"
+
+#define LOCTEXT_NAMESPACE "TargetLockVisibilityVolume"
+
+ATargetLockVisibilityVolume::ATargetLockVisibilityVolume()
+{
+	//Only a bounds for the bake, it must not block anything itself
+	GetBrushComponent()->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	GetBrushComponent()->SetGenerateOverlapEvents(false);
+}
+
+void ATargetLockVisibilityVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!HasBakedData()) return;
+
+	BuildPairOffsetIndices();
+	if (UTargetLockSubsystem* Subsystem = GetWorld()->GetSubsystem<UTargetLockSubsystem>())
+	{
+		Subsystem->RegisterVisibilityVolume(this);
+	}
+}
+
+void ATargetLockVisibilityVolume::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UTargetLockSubsystem* Subsystem = GetWorld()->GetSubsystem<UTargetLockSubsystem>())
+	{
+		Subsystem->UnregisterVisibilityVolume(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+#if WITH_EDITOR
+void ATargetLockVisibilityVolume::Bake()
+{
+	UWorld* World = GetWorld();
+	if (!World) return;
+
+	const FBox Bounds = GetBrushComponent()->Bounds.GetBox();
+	const FVector Size = Bounds.GetSize();
+
+	//Grow the cells until the grid fits into MaxCells
+	float Cell = CellSize;
+	FIntVector Count;
+	for (;;)
+	{
+		Count = FIntVector(
+			FMath::Max(1, FMath::CeilToInt(Size.X / Cell)),
+			FMath::Max(1, FMath::CeilToInt(Size.Y / Cell)),
+			FMath::Max(1, FMath::CeilToInt(Size.Z / Cell)));
+		if (static_cast<int64>(Count.X) * Count.Y * Count.Z <= MaxCells) break;
+		Cell *= 1.25f;
+	}
+
+	Modify();
+	GridOrigin = Bounds.Min;
+	BakedCellSize = Cell;
+	CellCount = Count;
+
+	//Only pairs within MaxPairDistance get a bit, the same offsets for every cell
+	const int32 Range = FMath::FloorToInt(MaxPairDistance / Cell);
+	PairRange = FIntVector(FMath::Min(Range, Count.X - 1), FMath::Min(Range, Count.Y - 1), FMath::Min(Range, Count.Z - 1));
+	PairOffsets.Reset();
+	for (int32 Z = 0; Z <= PairRange.Z; Z++)
+	{
+		for (int32 Y = -PairRange.Y; Y <= PairRange.Y; Y++)
+		{
+			for (int32 X = -PairRange.X; X <= PairRange.X; X++)
+			{
+				const FIntVector Offset(X, Y, Z);
+				if (IsStoredOffset(Offset) && FVector(Offset).Size() * Cell <= MaxPairDistance)
+				{
+					PairOffsets.Add(Offset);
+				}
+			}
+		}
+	}
+
+	const int32 NumCells = Count.X * Count.Y * Count.Z;
+	const int32 NumOffsets = PairOffsets.Num();
+	BlockedPairs.Init(0, FMath::Max<int32>(1, static_cast<int32>(FMath::DivideAndRoundUp<uint64>(static_cast<uint64>(NumCells) * NumOffsets, 32))));
+
+	//Only static geometry gets baked, everything that can move still has to be traced at runtime
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TargetLockVisibilityBake), true);
+	QueryParams.MobilityType = EQueryMobilityType::Static;
+	QueryParams.AddIgnoredActor(this);
+
+	FScopedSlowTask SlowTask(NumCells, LOCTEXT("Bake", "Baking target lock visibility..."));
+	SlowTask.MakeDialog(true);
+
+	for (int32 Z = 0; Z < Count.Z; Z++)
+	for (int32 Y = 0; Y < Count.Y; Y++)
+	for (int32 X = 0; X < Count.X; X++)
+	{
+		SlowTask.EnterProgressFrame();
+		if (SlowTask.ShouldCancel())
+		{
+			BlockedPairs.Reset();
+			return;
+		}
+
+		const FIntVector CellA(X, Y, Z);
+		const FVector CenterA = GridOrigin + (FVector(CellA) + 0.5) * Cell;
+		const uint64 RowStart = static_cast<uint64>(GetCellIndex(CellA)) * NumOffsets;
+
+		for (int32 OffsetIndex = 0; OffsetIndex < NumOffsets; OffsetIndex++)
+		{
+			const FIntVector CellB = CellA + PairOffsets[OffsetIndex];
+			if (CellB.X < 0 || CellB.Y < 0 || CellB.X >= Count.X || CellB.Y >= Count.Y || CellB.Z >= Count.Z) continue;
+
+			const FVector CenterB = GridOrigin + (FVector(CellB) + 0.5) * Cell;
+			if (IsPairSeparated(World, CenterA, CenterB, Cell, QueryParams))
+			{
+				const uint64 Bit = RowStart + OffsetIndex;
+				BlockedPairs[Bit / 32] |= 1u << (Bit % 32);
+			}
+		}
+	}
+}
+
+bool ATargetLockVisibilityVolume::IsPairSeparated(const UWorld* World, const FVector& CenterA, const FVector& CenterB, float Cell,
+	const FCollisionQueryParams& QueryParams) const
+{
+	//Center first, a pair that sees each other is usually found with the first trace. The corners are the real ones,
+	//so the lines along the outside of the pair are covered too.
+	constexpr float Corner = 0.5f;
+	const FVector SampleOffsets[] {
+		FVector::ZeroVector,
+		FVector(-Corner, -Corner, -Corner), FVector(Corner, -Corner, -Corner),
+		FVector(-Corner, Corner, -Corner), FVector(Corner, Corner, -Corner),
+		FVector(-Corner, -Corner, Corner), FVector(Corner, -Corner, Corner),
+		FVector(-Corner, Corner, Corner), FVector(Corner, Corner, Corner)
+	};
+
+	//Every sampled line has to end on the same component, lines blocked by different occluders may pass between them
+	UPrimitiveComponent* Occluder = nullptr;
+	for (const FVector& OffsetA : SampleOffsets)
+	{
+		for (const FVector& OffsetB : SampleOffsets)
+		{
+			FHitResult Hit;
+			if (!World->LineTraceSingleByChannel(Hit, CenterA + OffsetA * Cell, CenterB + OffsetB * Cell, TraceChannel, QueryParams)) return false;
+
+			UPrimitiveComponent* HitComponent = Hit.GetComponent();
+			if (!HitComponent || (Occluder && HitComponent != Occluder)) return false;
+			Occluder = HitComponent;
+		}
+	}
+
+	//The samples can miss a doorway or window in the occluder itself. Parallel lines through the cells, closer together
+	//than the smallest opening, find every opening. Seen along any direction a cell covers at most a disc of half its
+	//diagonal, so that radius spans the whole silhouette of the pair. Lines past the silhouette only err on the open side.
+	FVector Right, Up;
+	(CenterB - CenterA).GetSafeNormal().FindBestAxisVectors(Right, Up);
+
+	const float Spacing = MinOpeningSize * UE_INV_SQRT_2;
+	const float Radius = Cell * UE_HALF_SQRT_3;
+	const int32 Steps = FMath::FloorToInt(Radius / Spacing);
+
+	FCollisionQueryParams OccluderParams(SCENE_QUERY_STAT(TargetLockVisibilityBakeOpening), QueryParams.bTraceComplex);
+	for (int32 U = -Steps; U <= Steps; U++)
+	{
+		for (int32 V = -Steps; V <= Steps; V++)
+		{
+			if (FMath::Square(U * Spacing) + FMath::Square(V * Spacing) > FMath::Square(Radius)) continue;
+
+			const FVector Offset = Right * (U * Spacing) + Up * (V * Spacing);
+			FHitResult Hit;
+			if (!Occluder->LineTraceComponent(Hit, CenterA + Offset, CenterB + Offset, OccluderParams)) return false;
+		}
+	}
+	return true;
+}
+
+void ATargetLockVisibilityVolume::ClearBakedData()
+{
+	Modify();
+	BlockedPairs.Empty();
+	PairOffsets.Empty();
+	PairRange = FIntVector::ZeroValue;
+	CellCount = FIntVector::ZeroValue;
+	BakedCellSize = 0;
+}
+#endif
+
+bool ATargetLockVisibilityVolume::IsStaticallyBlocked(const FVector& From, const FVector& To, float Margin) const
+{
+	if (!HasBakedData()) return false;
+
+	FIntVector FromMin, FromMax, ToMin, ToMax;
+	if (!GetCellRange(From, Margin, FromMin, FromMax) || !GetCellRange(To, Margin, ToMin, ToMax)) return false;
+
+	for (int32 FromZ = FromMin.Z; FromZ <= FromMax.Z; FromZ++)
+	for (int32 FromY = FromMin.Y; FromY <= FromMax.Y; FromY++)
+	for (int32 FromX = FromMin.X; FromX <= FromMax.X; FromX++)
+	{
+		const FIntVector FromCell(FromX, FromY, FromZ);
+		for (int32 ToZ = ToMin.Z; ToZ <= ToMax.Z; ToZ++)
+		for (int32 ToY = ToMin.Y; ToY <= ToMax.Y; ToY++)
+		for (int32 ToX = ToMin.X; ToX <= ToMax.X; ToX++)
+		{
+			if (!IsPairBlocked(FromCell, FIntVector(ToX, ToY, ToZ))) return false;
+		}
+	}
+	return true;
+}
+
+bool ATargetLockVisibilityVolume::GetCellRange(const FVector& Center, float Margin, FIntVector& OutMin, FIntVector& OutMax) const
+{
+	const FVector Min = (Center - Margin - GridOrigin) / BakedCellSize;
+	const FVector Max = (Center + Margin - GridOrigin) / BakedCellSize;
+
+	OutMin = FIntVector(FMath::FloorToInt(Min.X), FMath::FloorToInt(Min.Y), FMath::FloorToInt(Min.Z));
+	OutMax = FIntVector(FMath::FloorToInt(Max.X), FMath::FloorToInt(Max.Y), FMath::FloorToInt(Max.Z));
+
+	return OutMin.X >= 0 && OutMin.Y >= 0 && OutMin.Z >= 0 &&
+		OutMax.X < CellCount.X && OutMax.Y < CellCount.Y && OutMax.Z < CellCount.Z;
+}
+
+void ATargetLockVisibilityVolume::BuildPairOffsetIndices()
+{
+	const FIntVector Size(PairRange.X * 2 + 1, PairRange.Y * 2 + 1, PairRange.Z + 1);
+	PairOffsetIndices.Init(INDEX_NONE, Size.X * Size.Y * Size.Z);
+
+	for (int32 i = 0; i < PairOffsets.Num(); i++)
+	{
+		const FIntVector& Offset = PairOffsets[i];
+		PairOffsetIndices[(Offset.Z * Size.Y + Offset.Y + PairRange.Y) * Size.X + Offset.X + PairRange.X] = i;
+	}
+}
+
+int32 ATargetLockVisibilityVolume::GetPairOffsetIndex(const FIntVector& Offset) const
+{
+	if (Offset.Z < 0 || Offset.Z > PairRange.Z || FMath::Abs(Offset.Y) > PairRange.Y || FMath::Abs(Offset.X) > PairRange.X) return INDEX_NONE;
+
+	const int32 SizeX = PairRange.X * 2 + 1;
+	const int32 SizeY = PairRange.Y * 2 + 1;
+	const int32 Index = (Offset.Z * SizeY + Offset.Y + PairRange.Y) * SizeX + Offset.X + PairRange.X;
+	return PairOffsetIndices.IsValidIndex(Index) ? PairOffsetIndices[Index] : INDEX_NONE;
+}
+
+bool ATargetLockVisibilityVolume::IsPairBlocked(const FIntVector& A, const FIntVector& B) const
+{
+	//A cell can always see itself
+	if (A == B) return false;
+
+	//The pair is stored at the cell its offset points away from
+	FIntVector Cell = A;
+	FIntVector Offset = B - A;
+	if (!IsStoredOffset(Offset))
+	{
+		Cell = B;
+		Offset = -Offset;
+	}
+
+	//Too far apart to be baked, has to be traced
+	const int32 OffsetIndex = GetPairOffsetIndex(Offset);
+	if (OffsetIndex == INDEX_NONE) return false;
+
+	const uint64 Bit = static_cast<uint64>(GetCellIndex(Cell)) * PairOffsets.Num() + OffsetIndex;
+	const uint64 Word = Bit / 32;
+	return Word < static_cast<uint64>(BlockedPairs.Num()) && (BlockedPairs[Word] & (1u << (Bit % 32))) != 0;
+}
+
+#undef LOCTEXT_NAMESPACE
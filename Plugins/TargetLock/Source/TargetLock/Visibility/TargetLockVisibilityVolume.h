@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Volume.h"
+#include "TargetLockVisibilityVolume.generated.h"
+
+/**
+ * Baked cell to cell visibility of the static level geometry inside the volume. Every pair of cells that a single static
+ * occluder fully separates is stored as one bit, only for cells within MaxPairDistance of each other, so the Line of
+ * Sight checks can skip their traces for targets that are definitely hidden behind the level. Only movable occluders
+ * still need the traces.
+ * The baked data is saved with the actor, so it streams in and out with its level. Bake again after changing the level.
+ */
+UCLASS(hidecategories = (Advanced, Attachment, Collision, Volume, Navigation))
+class TARGETLOCK_API ATargetLockVisibilityVolume : public AVolume
+{
+	GENERATED_BODY()
+
+public:
+	ATargetLockVisibilityVolume();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+#if WITH_EDITOR
+	//Traces every pair of cells against the static geometry and stores which pairs a single occluder separates
+	UFUNCTION(CallInEditor, Category = "Target Lock")
+	void Bake();
+
+	//Drops the baked data, the Line of Sight checks trace as usual then
+	UFUNCTION(CallInEditor, Category = "Target Lock")
+	void ClearBakedData();
+#endif
+
+	/**
+	 * True if every cell within Margin around From is baked as not seeing every cell within Margin around To.
+	 * Conservative: pairs behind gaps between occluders or behind openings of at least MinOpeningSize stay visible.
+	 *
+	 * @param Margin How far the traces that would be skipped start or end away from From and To.
+	 * @return False if there is no baked data or one of the boxes leaves the volume.
+	 */
+	bool IsStaticallyBlocked(const FVector& From, const FVector& To, float Margin) const;
+
+	bool HasBakedData() const { return BlockedPairs.Num() > 0 && PairOffsets.Num() > 0; }
+
+	//Size of the cells. The bake uses larger cells if the volume would have more than MaxCells cells.
+	UPROPERTY(EditAnywhere, meta = (Units = "cm", ClampMin = "100"), Category = "Target Lock")
+	float CellSize = 500;
+
+	//Upper limit for the number of cells. The baked data takes one bit per cell and cell within MaxPairDistance of it,
+	//so it grows linearly with the cells. 4096 cells of 500 cm take up to 2 MB with the default distance.
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "8", ClampMax = "16384"), Category = "Target Lock")
+	int32 MaxCells = 4096;
+
+	//Cells further apart than this are not baked, they always get traced
+	UPROPERTY(EditAnywhere, meta = (Units = "cm", ClampMin = "100"), Category = "Target Lock")
+	float MaxPairDistance = 6000;
+
+	//The channel the bake traces with, should block the same static geometry as the Line of Sight traces
+	UPROPERTY(EditAnywhere, Category = "Target Lock")
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+	//Openings in an occluder at least this wide, e.g. doorways and windows, keep the cells on both sides visible to each other.
+	//Smaller values bake slower.
+	UPROPERTY(EditAnywhere, meta = (Units = "cm", ClampMin = "10"), Category = "Target Lock")
+	float MinOpeningSize = 60;
+
+protected:
+#if WITH_EDITOR
+	//True if one static component blocks every sampled line between the two cells and has no opening across them
+	bool IsPairSeparated(const UWorld* World, const FVector& CenterA, const FVector& CenterB, float Cell,
+		const FCollisionQueryParams& QueryParams) const;
+#endif
+
+	int32 GetCellIndex(const FIntVector& Cell) const { return (Cell.Z * CellCount.Y + Cell.Y) * CellCount.X + Cell.X; }
+
+	//Cell range of the box, false if it isn't fully inside the grid
+	bool GetCellRange(const FVector& Center, float Margin, FIntVector& OutMin, FIntVector& OutMax) const;
+
+	//Only one of the two directions of a pair is stored, the one pointing up (then along +Y, then along +X)
+	static bool IsStoredOffset(const FIntVector& Offset) { return Offset.Z > 0 || (Offset.Z == 0 && (Offset.Y > 0 || (Offset.Y == 0 && Offset.X > 0))); }
+
+	//Index into PairOffsets, INDEX_NONE if the offset is too far to be baked
+	int32 GetPairOffsetIndex(const FIntVector& Offset) const;
+
+	//Fills PairOffsetIndices from the baked PairOffsets
+	void BuildPairOffsetIndices();
+
+	bool IsPairBlocked(const FIntVector& A, const FIntVector& B) const;
+
+	//The bake results, only written by Bake
+
+	UPROPERTY(VisibleInstanceOnly, Category = "Target Lock|Baked")
+	FVector GridOrigin = FVector::ZeroVector;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "Target Lock|Baked")
+	float BakedCellSize = 0;
+
+	UPROPERTY(VisibleInstanceOnly, Category = "Target Lock|Baked")
+	FIntVector CellCount = FIntVector::ZeroValue;
+
+	//Offsets from a cell to the cells within MaxPairDistance, only the stored direction of every pair (see IsStoredOffset)
+	UPROPERTY()
+	TArray<FIntVector> PairOffsets;
+
+	//Largest offset along every axis in PairOffsets
+	UPROPERTY()
+	FIntVector PairRange = FIntVector::ZeroValue;
+
+	//PairOffsets.Num() bits per cell, set if the cell can't see the cell at that offset
+	UPROPERTY()
+	TArray<uint32> BlockedPairs;
+
+	//Index into PairOffsets for every offset within PairRange, the Z >= 0 half only. Built in BeginPlay.
+	TArray<int32> PairOffsetIndices;
+};
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLock/Visualization/TargetLockIndicatorRenderer.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+
+ATargetLockIndicatorRenderer::ATargetLockIndicatorRenderer(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryActorTick.bCanEverTick = false;
+	SetCanBeDamaged(false);
+
+	IndicatorComponent = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("IndicatorComponent"));
+	IndicatorComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	IndicatorComponent->SetCastShadow(false);
+	IndicatorComponent->SetGenerateOverlapEvents(false);
+	IndicatorComponent->SetCanEverAffectNavigation(false);
+	IndicatorComponent->SetMobility(EComponentMobility::Movable);
+	RootComponent = IndicatorComponent;
+}
+
+void ATargetLockIndicatorRenderer::SetIndicatorMesh(UStaticMesh* Mesh)
+{
+	IndicatorComponent->SetStaticMesh(Mesh);
+}
+
+void ATargetLockIndicatorRenderer::UpdateIndicators(const TArray<FTransform>& Transforms)
+{
+	const int32 InstanceCount = IndicatorComponent->GetInstanceCount();
+	const int32 TargetCount = Transforms.Num();
+
+	if (TargetCount < InstanceCount)
+	{
+		//Remove from the back so the remaining instance indices don't get shuffled
+		TArray<int32> InstancesToRemove;
+		InstancesToRemove.Reserve(InstanceCount - TargetCount);
+		for (int32 i = InstanceCount - 1; i >= TargetCount; i--)
+		{
+			InstancesToRemove.Add(i);
+		}
+		IndicatorComponent->RemoveInstances(InstancesToRemove);
+	}
+	else if (TargetCount > InstanceCount)
+	{
+		const TArray<FTransform> NewInstances(Transforms.GetData() + InstanceCount, TargetCount - InstanceCount);
+		IndicatorComponent->AddInstances(NewInstances, false, true);
+	}
+
+	if (TargetCount > 0)
+	{
+		IndicatorComponent->BatchUpdateInstancesTransforms(0, Transforms, true, true, true);
+	}
+}
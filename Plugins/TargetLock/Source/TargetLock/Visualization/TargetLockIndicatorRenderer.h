@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TargetLockIndicatorRenderer.generated.h"
+
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/**
+ * Draws every lock indicator that uses the same mesh through a single instanced static mesh component.
+ * Spawned and fed by the UTargetLockSubsystem, there is no need to place this in a level.
+ */
+UCLASS(NotPlaceable, Transient)
+class TARGETLOCK_API ATargetLockIndicatorRenderer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATargetLockIndicatorRenderer(const FObjectInitializer& ObjectInitializer);
+
+	void SetIndicatorMesh(UStaticMesh* Mesh);
+
+	/**
+	 * Writes all instance transforms in one go. Instances are only added or removed at the end of the
+	 * component, so indices stay stable and the render state is only dirtied once per call.
+	 *
+	 * @param Transforms World space transforms, one per indicator.
+	 */
+	void UpdateIndicators(const TArray<FTransform>& Transforms);
+
+	UInstancedStaticMeshComponent* GetIndicatorComponent() const { return IndicatorComponent; }
+
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Target Lock | Visualization")
+	TObjectPtr<UInstancedStaticMeshComponent> IndicatorComponent;
+};
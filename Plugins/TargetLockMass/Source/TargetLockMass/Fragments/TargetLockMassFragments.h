@@ -0,0 +1,18 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "TargetLockMassFragments.generated.h"
+
+//Marks a Mass entity as something target locks can lock onto. Needs a FTransformFragment next to it.
+USTRUCT()
+struct TARGETLOCKMASS_API FTargetLockableFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	//Height above the entity location that locks aim at
+	UPROPERTY(EditAnywhere, meta = (Units = "CM"), Category = "Target Lock")
+	float AimHeight = 90;
+};
@@ -0,0 +1,5 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TargetLockMass.h"
+
+IMPLEMENT_MODULE(FTargetLockMassModule, TargetLockMass)
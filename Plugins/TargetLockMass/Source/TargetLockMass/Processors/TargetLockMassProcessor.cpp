@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLockMass/Processors/TargetLockMassProcessor.h"
+#include "TargetLockMass/Fragments/TargetLockMassFragments.h"
+#include "TargetLockMass/Subsystems/TargetLockMassSubsystem.h"
+#include "MassCommonFragments.h"
+#include "MassCommonTypes.h"
+#include "MassExecutionContext.h"
+
+UTargetLockMassProcessor::UTargetLockMassProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+	ProcessingPhase = EMassProcessingPhase::PostPhysics;
+	ExecutionOrder.ExecuteAfter.Add(UE::Mass::ProcessorGroupNames::Movement);
+
+	//The snapshot is read by target searches on the game thread, writing it from a worker would race with them
+	bRequiresGameThreadExecution = true;
+}
+
+void UTargetLockMassProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadOnly);
+	EntityQuery.AddRequirement<FTargetLockableFragment>(EMassFragmentAccess::ReadOnly);
+}
+
+void UTargetLockMassProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	UTargetLockMassSubsystem* Subsystem = UWorld::GetSubsystem<UTargetLockMassSubsystem>(EntityManager.GetWorld());
+	if (!Subsystem) return;
+
+	Subsystem->ResetSnapshot(EntityQuery.GetNumMatchingEntities(EntityManager));
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [Subsystem](FMassExecutionContext& ChunkContext)
+	{
+		Subsystem->AddChunk(ChunkContext.GetEntities(), ChunkContext.GetFragmentView<FTransformFragment>(),
+			ChunkContext.GetFragmentView<FTargetLockableFragment>());
+	});
+
+	Subsystem->FinishSnapshot();
+}
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityQuery.h"
+#include "MassProcessor.h"
+#include "TargetLockMassProcessor.generated.h"
+
+//Copies the aim locations of all lockable agents into the spatial hash of the UTargetLockMassSubsystem after they moved
+UCLASS()
+class TARGETLOCKMASS_API UTargetLockMassProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UTargetLockMassProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+};
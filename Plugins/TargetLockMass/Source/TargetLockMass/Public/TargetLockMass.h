@@ -0,0 +1,11 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+//Lets target locks lock onto MassEntity crowd agents, see UTargetLockMassSubsystem
+class FTargetLockMassModule : public IModuleInterface
+{
+};
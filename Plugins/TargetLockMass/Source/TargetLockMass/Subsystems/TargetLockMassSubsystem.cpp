@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TargetLockMass/Subsystems/TargetLockMassSubsystem.h"
+#include "TargetLockMass/Fragments/TargetLockMassFragments.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+#include "MassCommonFragments.h"
+#include "MassEntitySubsystem.h"
+
+bool UTargetLockMassSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UTargetLockMassSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	MassEntitySubsystem = Collection.InitializeDependency<UMassEntitySubsystem>();
+	if (UTargetLockSubsystem* TargetLockSubsystem = Collection.InitializeDependency<UTargetLockSubsystem>())
+	{
+		TargetLockSubsystem->SetEntitySource(this);
+	}
+}
+
+void UTargetLockMassSubsystem::Deinitialize()
+{
+	if (UTargetLockSubsystem* TargetLockSubsystem = GetWorld()->GetSubsystem<UTargetLockSubsystem>())
+	{
+		TargetLockSubsystem->SetEntitySource(nullptr);
+	}
+
+	Entities.Empty();
+	Locations.Empty();
+	CellRanges.Empty();
+	SortedEntities.Empty();
+	SortedLocations.Empty();
+
+	Super::Deinitialize();
+}
+
+void UTargetLockMassSubsystem::GatherEntities(const FVector& Origin, float Radius, TArray<FTargetLockTargetHandle>& OutTargets,
+	TArray<FVector>& OutLocations) const
+{
+	const FIntVector MinCell = GetCell(Origin - FVector(Radius));
+	const FIntVector MaxCell = GetCell(Origin + FVector(Radius));
+	const double RadiusSquared = static_cast<double>(Radius) * Radius;
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+			{
+				const TPair<int32, int32>* Range = CellRanges.Find(FIntVector(X, Y, Z));
+				if (!Range) continue;
+
+				const int32 End = Range->Key + Range->Value;
+				for (int32 i = Range->Key; i < End; i++)
+				{
+					if (FVector::DistSquared(Origin, Locations[i]) > RadiusSquared) continue;
+
+					OutTargets.Add(MakeTargetHandle(Entities[i]));
+					OutLocations.Add(Locations[i]);
+				}
+			}
+		}
+	}
+}
+
+bool UTargetLockMassSubsystem::GetEntityLocation(const FTargetLockTargetHandle& Target, FVector& OutLocation) const
+{
+	if (!MassEntitySubsystem || !Target.IsEntity()) return false;
+
+	const FMassEntityManager& EntityManager = MassEntitySubsystem->GetEntityManager();
+	const FMassEntityHandle Entity = GetEntityHandle(Target);
+	if (!EntityManager.IsEntityActive(Entity)) return false;
+
+	//Locked entities are read directly, they have to follow the agent every frame and not only after the processor ran
+	const FTransformFragment* Transform = EntityManager.GetFragmentDataPtr<FTransformFragment>(Entity);
+	const FTargetLockableFragment* Lockable = EntityManager.GetFragmentDataPtr<FTargetLockableFragment>(Entity);
+	if (!Transform || !Lockable) return false;
+
+	OutLocation = Transform->GetTransform().GetLocation() + FVector(0, 0, Lockable->AimHeight);
+	return true;
+}
+
+void UTargetLockMassSubsystem::ResetSnapshot(int32 ExpectedNum)
+{
+	Entities.Reset(ExpectedNum);
+	Locations.Reset(ExpectedNum);
+	CellRanges.Reset();
+}
+
+void UTargetLockMassSubsystem::AddChunk(TConstArrayView<FMassEntityHandle> ChunkEntities, TConstArrayView<FTransformFragment> Transforms,
+	TConstArrayView<FTargetLockableFragment> Lockables)
+{
+	Entities.Append(ChunkEntities.GetData(), ChunkEntities.Num());
+
+	const int32 First = Locations.AddUninitialized(Transforms.Num());
+	for (int32 i = 0; i < Transforms.Num(); i++)
+	{
+		Locations[First + i] = Transforms[i].GetTransform().GetLocation() + FVector(0, 0, Lockables[i].AimHeight);
+	}
+}
+
+void UTargetLockMassSubsystem::FinishSnapshot()
+{
+	struct FEntry
+	{
+		FIntVector Cell;
+		int32 Index;
+	};
+
+	TArray<FEntry> Order;
+	Order.Reserve(Locations.Num());
+	for (int32 i = 0; i < Locations.Num(); i++)
+	{
+		Order.Add({ GetCell(Locations[i]), i });
+	}
+
+	Order.Sort([](const FEntry& A, const FEntry& B)
+	{
+		if (A.Cell.X != B.Cell.X) return A.Cell.X < B.Cell.X;
+		if (A.Cell.Y != B.Cell.Y) return A.Cell.Y < B.Cell.Y;
+		return A.Cell.Z < B.Cell.Z;
+	});
+
+	SortedEntities.Reset(Order.Num());
+	SortedLocations.Reset(Order.Num());
+	CellRanges.Reset();
+
+	for (int32 i = 0; i < Order.Num(); i++)
+	{
+		const FEntry& Entry = Order[i];
+		SortedEntities.Add(Entities[Entry.Index]);
+		SortedLocations.Add(Locations[Entry.Index]);
+
+		if (i == 0 || Order[i - 1].Cell != Entry.Cell)
+		{
+			CellRanges.Add(Entry.Cell, { i, 0 });
+		}
+		CellRanges[Entry.Cell].Value++;
+	}
+
+	Swap(Entities, SortedEntities);
+	Swap(Locations, SortedLocations);
+}
+
+FIntVector UTargetLockMassSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TargetLock/Subsystems/TargetLockEntitySource.h"
+#include "TargetLockMassSubsystem.generated.h"
+
+class UMassEntitySubsystem;
+struct FTargetLockableFragment;
+struct FTransformFragment;
+
+/**
+ * Entity source of the UTargetLockSubsystem for Mass agents with a FTargetLockableFragment.
+ * UTargetLockMassProcessor copies the aim locations of all lockable agents in here once per frame, chunk by chunk,
+ * and the snapshot gets bucketed into a spatial hash like FTargetLockCandidateIndex. Searching for targets only
+ * runs over the contiguous entries of the cells in range instead of touching the entity manager per agent.
+ */
+UCLASS()
+class TARGETLOCKMASS_API UTargetLockMassSubsystem : public UWorldSubsystem, public ITargetLockEntitySource
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	//ITargetLockEntitySource
+	virtual void GatherEntities(const FVector& Origin, float Radius, TArray<FTargetLockTargetHandle>& OutTargets, TArray<FVector>& OutLocations) const override;
+	virtual bool GetEntityLocation(const FTargetLockTargetHandle& Target, FVector& OutLocation) const override;
+
+	//Called by UTargetLockMassProcessor before the first chunk of a frame
+	void ResetSnapshot(int32 ExpectedNum);
+
+	//Called by UTargetLockMassProcessor for every chunk of lockable agents
+	void AddChunk(TConstArrayView<FMassEntityHandle> ChunkEntities, TConstArrayView<FTransformFragment> Transforms,
+		TConstArrayView<FTargetLockableFragment> Lockables);
+
+	//Called by UTargetLockMassProcessor after the last chunk of a frame, sorts the snapshot by cell
+	void FinishSnapshot();
+
+	int32 GetLockableEntityCount() const { return Entities.Num(); }
+
+	static FTargetLockTargetHandle MakeTargetHandle(const FMassEntityHandle Entity)
+	{
+		return FTargetLockTargetHandle::FromEntity(Entity.Index, Entity.SerialNumber);
+	}
+
+	static FMassEntityHandle GetEntityHandle(const FTargetLockTargetHandle& Target)
+	{
+		return Target.IsEntity() ? FMassEntityHandle(Target.EntityIndex, Target.EntitySerialNumber) : FMassEntityHandle();
+	}
+
+protected:
+	FIntVector GetCell(const FVector& Location) const;
+
+	UPROPERTY()
+	TObjectPtr<UMassEntitySubsystem> MassEntitySubsystem;
+
+	//Edge length of the cells of the snapshot
+	double CellSize = 2500;
+
+	//Snapshot of the last processor run, parallel arrays sorted by cell once FinishSnapshot ran
+	TArray<FMassEntityHandle> Entities;
+	TArray<FVector> Locations;
+
+	//First entry and number of entries of every cell with agents in it
+	TMap<FIntVector, TPair<int32, int32>> CellRanges;
+
+	//Reused by FinishSnapshot, swapped with the snapshot arrays
+	TArray<FMassEntityHandle> SortedEntities;
+	TArray<FVector> SortedLocations;
+};
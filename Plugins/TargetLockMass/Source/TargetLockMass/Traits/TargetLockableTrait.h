@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTraitBase.h"
+#include "TargetLockMass/Fragments/TargetLockMassFragments.h"
+#include "TargetLockableTrait.generated.h"
+
+//Add to a Mass entity config to make its agents lockable
+UCLASS(meta = (DisplayName = "Target Lockable"))
+class TARGETLOCKMASS_API UTargetLockableTrait : public UMassEntityTraitBase
+{
+	GENERATED_BODY()
+
+public:
+	virtual void BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const override;
+
+	UPROPERTY(EditAnywhere, Category = "Target Lock")
+	FTargetLockableFragment Lockable;
+};
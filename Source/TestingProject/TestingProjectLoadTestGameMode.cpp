@@ -0,0 +1,204 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "TestingProjectLoadTestGameMode.h"
+#include "TestingProjectCharacter.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerStart.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/App.h"
+#include "TargetLock/Subsystems/TargetLockSubsystem.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTargetLockLoadTest, Log, All);
+
+ATestingProjectLoadTestGameMode::ATestingProjectLoadTestGameMode()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	BotClass = ATestingProjectCharacter::StaticClass();
+}
+
+void ATestingProjectLoadTestGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	// URL options override the config, e.g. ?Bots=500?Duration=120
+	BotCount = UGameplayStatics::GetIntOption(Options, TEXT("Bots"), BotCount);
+
+	const auto ParseFloatOption = [&Options](const TCHAR* Key, float& InOutValue)
+	{
+		if (UGameplayStatics::HasOption(Options, Key))
+		{
+			InOutValue = FCString::Atof(*UGameplayStatics::ParseOption(Options, Key));
+		}
+	};
+	ParseFloatOption(TEXT("Duration"), Duration);
+	ParseFloatOption(TEXT("Warmup"), WarmupTime);
+}
+
+void ATestingProjectLoadTestGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	Random.Initialize(1337);
+	SpawnBots();
+}
+
+void ATestingProjectLoadTestGameMode::SpawnBots()
+{
+	UWorld* World = GetWorld();
+	if (!BotClass || BotCount <= 0) return;
+
+	if (!LockAbility)
+	{
+		UE_LOG(LogTargetLockLoadTest, Warning, TEXT("No LockAbility set, the bots only strafe"));
+	}
+
+	FVector Origin = FVector::ZeroVector;
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		Origin = It->GetActorLocation();
+		break;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	// Square grid around the player start, bots face +X so their neighbours are in front of them
+	const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(BotCount)));
+	Bots.Reserve(BotCount);
+	for (int32 Index = 0; Index < BotCount; Index++)
+	{
+		const FVector Offset((Index % Side - Side / 2) * BotSpacing, (Index / Side - Side / 2) * BotSpacing, 0);
+		ACharacter* Character = World->SpawnActor<ACharacter>(BotClass, Origin + Offset, FRotator::ZeroRotator, SpawnParams);
+		if (!Character) continue;
+
+		if (!Character->GetController())
+		{
+			Character->SpawnDefaultController();
+		}
+
+		FBot& Bot = Bots.AddDefaulted_GetRef();
+		Bot.Character = Character;
+		Bot.NextToggle = Random.FRandRange(ToggleInterval.X, ToggleInterval.Y);
+		Bot.NextStrafeChange = Random.FRandRange(StrafeInterval.X, StrafeInterval.Y);
+		Bot.StrafeDirection = Random.RandBool() ? 1 : -1;
+
+		UAbilitySystemComponent* AbilitySystem = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(Character);
+		if (AbilitySystem && LockAbility)
+		{
+			AbilitySystem->InitAbilityActorInfo(Character, Character);
+			Bot.AbilitySystem = AbilitySystem;
+			Bot.LockAbilityHandle = AbilitySystem->GiveAbility(FGameplayAbilitySpec(LockAbility, 1, INDEX_NONE, this));
+		}
+	}
+
+	UE_LOG(LogTargetLockLoadTest, Display, TEXT("Spawned %d bots, measuring %.0fs after %.0fs of warmup, then %.0fs of counters"), Bots.Num(), Duration, WarmupTime, CounterDuration);
+}
+
+void ATestingProjectLoadTestGameMode::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	// Real time, the duration of the test shouldn't depend on time dilation
+	ElapsedTime += FApp::GetDeltaTime();
+	UpdateBots();
+
+	if (bReported || ElapsedTime < WarmupTime) return;
+
+	// Frame times first, with the debug stats collection off so its overhead isn't part of them
+	if (Duration <= 0 || ElapsedTime < WarmupTime + Duration)
+	{
+		FrameTimes.Add((FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000);
+
+		for (const FBot& Bot : Bots)
+		{
+			UAbilitySystemComponent* AbilitySystem = Bot.AbilitySystem.Get();
+			const FGameplayAbilitySpec* Spec = AbilitySystem ? AbilitySystem->FindAbilitySpecFromHandle(Bot.LockAbilityHandle) : nullptr;
+			LockingBotSamples += Spec && Spec->IsActive();
+		}
+		return;
+	}
+
+	if (UTargetLockSubsystem* Subsystem = GetWorld()->GetSubsystem<UTargetLockSubsystem>())
+	{
+		// Stats are read one frame late, the first frame of the phase only turns the collection on
+		if (const FTargetLockDebugStats* Stats = Subsystem->GetDebugStats())
+		{
+			CounterFrames++;
+			LineOfSightTraces += Stats->LastFrame.LineOfSightTraces;
+			SkippedTraces += Stats->LastFrame.SkippedTraces;
+			AcquisitionMicroseconds += Stats->LastFrame.AcquisitionMicroseconds;
+			SolveMicroseconds += Stats->LastFrame.SolveMicroseconds;
+		}
+		Subsystem->RequestDebugStats(nullptr);
+	}
+
+	if (ElapsedTime >= WarmupTime + Duration + CounterDuration)
+	{
+		Report();
+	}
+}
+
+void ATestingProjectLoadTestGameMode::UpdateBots()
+{
+	for (FBot& Bot : Bots)
+	{
+		ACharacter* Character = Bot.Character.Get();
+		if (!Character) continue;
+
+		if (ElapsedTime >= Bot.NextStrafeChange)
+		{
+			Bot.StrafeDirection = -Bot.StrafeDirection;
+			Bot.NextStrafeChange = ElapsedTime + Random.FRandRange(StrafeInterval.X, StrafeInterval.Y);
+		}
+		Character->AddMovementInput(Character->GetActorRightVector(), Bot.StrafeDirection);
+
+		UAbilitySystemComponent* AbilitySystem = Bot.AbilitySystem.Get();
+		if (!AbilitySystem || ElapsedTime < Bot.NextToggle) continue;
+
+		Bot.NextToggle = ElapsedTime + Random.FRandRange(ToggleInterval.X, ToggleInterval.Y);
+
+		// Cancel instead of activating again, that only toggles if the ability allows retriggering
+		const FGameplayAbilitySpec* Spec = AbilitySystem->FindAbilitySpecFromHandle(Bot.LockAbilityHandle);
+		if (Spec && Spec->IsActive())
+		{
+			AbilitySystem->CancelAbilityHandle(Bot.LockAbilityHandle);
+		}
+		else
+		{
+			AbilitySystem->TryActivateAbility(Bot.LockAbilityHandle);
+		}
+	}
+}
+
+void ATestingProjectLoadTestGameMode::Report()
+{
+	bReported = true;
+
+	const int32 Frames = FrameTimes.Num();
+	if (Frames == 0) return;
+
+	FrameTimes.Sort();
+	const auto Percentile = [this, Frames](float Percent)
+	{
+		return FrameTimes[FMath::Min(Frames - 1, FMath::FloorToInt(Frames * Percent / 100))];
+	};
+
+	UE_LOG(LogTargetLockLoadTest, Display, TEXT("Target lock load test: %d bots, %d frames"), Bots.Num(), Frames);
+	UE_LOG(LogTargetLockLoadTest, Display, TEXT("  Frame time ms, debug stats off: p50 %.2f  p90 %.2f  p95 %.2f  p99 %.2f  max %.2f"),
+		Percentile(50), Percentile(90), Percentile(95), Percentile(99), FrameTimes.Last());
+	UE_LOG(LogTargetLockLoadTest, Display, TEXT("  Locking bots per frame: %.1f"), static_cast<double>(LockingBotSamples) / Frames);
+
+	// The counters come from a later phase with the stats collection on, their timings include its overhead
+	const int32 StatFrames = FMath::Max(CounterFrames, 1);
+	UE_LOG(LogTargetLockLoadTest, Display, TEXT("  Counters over %d frames with debug stats on: %.1f Line of Sight traces, %.1f skipped, acquisition %.1f us, solve %.1f us per frame"),
+		CounterFrames, static_cast<double>(LineOfSightTraces) / StatFrames, static_cast<double>(SkippedTraces) / StatFrames,
+		AcquisitionMicroseconds / StatFrames, SolveMicroseconds / StatFrames);
+
+	// Unattended runs end here, in the editor the session keeps going
+	if (!GIsEditor)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TestingProjectGameMode.h"
+#include "GameplayAbilitySpecHandle.h"
+#include "TestingProjectLoadTestGameMode.generated.h"
+
+class ACharacter;
+class UAbilitySystemComponent;
+class UGameplayAbility;
+
+/**
+ * Load test for the target lock plugin. Spawns bots that toggle their target lock ability and strafe around,
+ * then logs frame time percentiles and the counters of the target lock subsystem.
+ * Meant for a headless server, e.g.:
+ *   TestingProjectServer ThirdPersonMap?game=/Script/TestingProject.TestingProjectLoadTestGameMode?Bots=500?Duration=120 -nullrhi -log
+ * Options: Bots (number of bots), Duration (seconds to measure, the server quits after the report, 0 runs forever), Warmup (seconds before measuring).
+ * The plugin counters come from FTargetLockDebugStats and stay 0 in builds without the gameplay debugger. Collecting them
+ * costs time itself, so they are read in a phase of their own after the frame times got measured.
+ */
+UCLASS(config=Game)
+class ATestingProjectLoadTestGameMode : public ATestingProjectGameMode
+{
+	GENERATED_BODY()
+
+public:
+	ATestingProjectLoadTestGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void StartPlay() override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	//The bots. Needs an ability system component, like ATestingProjectCharacter.
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Load Test")
+	TSubclassOf<ACharacter> BotClass;
+
+	//Target lock ability granted to every bot, e.g. a Blueprint child of UGASAbility_TargetLock. Activating it toggles the lock.
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Load Test")
+	TSubclassOf<UGameplayAbility> LockAbility;
+
+	UPROPERTY(Config, EditDefaultsOnly, Category = "Load Test")
+	int32 BotCount = 100;
+
+	//Bots get spawned on a square grid around the first player start
+	UPROPERTY(Config, EditDefaultsOnly, meta = (Units = "cm"), Category = "Load Test")
+	float BotSpacing = 300;
+
+	//Bots toggle their lock after a random time in this range
+	UPROPERTY(Config, EditDefaultsOnly, meta = (Units = "s"), Category = "Load Test")
+	FVector2D ToggleInterval = FVector2D(1, 4);
+
+	//Bots change their strafe direction after a random time in this range
+	UPROPERTY(Config, EditDefaultsOnly, meta = (Units = "s"), Category = "Load Test")
+	FVector2D StrafeInterval = FVector2D(0.5, 2);
+
+	UPROPERTY(Config, EditDefaultsOnly, meta = (Units = "s"), Category = "Load Test")
+	float WarmupTime = 5;
+
+	//How long to measure the frame times, 0 measures until the game ends and never reports
+	UPROPERTY(Config, EditDefaultsOnly, meta = (Units = "s"), Category = "Load Test")
+	float Duration = 60;
+
+	//How long to read the plugin counters after the frame times, with the debug stats collection on
+	UPROPERTY(Config, EditDefaultsOnly, meta = (Units = "s"), Category = "Load Test")
+	float CounterDuration = 10;
+
+protected:
+	struct FBot
+	{
+		TWeakObjectPtr<ACharacter> Character;
+		TWeakObjectPtr<UAbilitySystemComponent> AbilitySystem;
+		FGameplayAbilitySpecHandle LockAbilityHandle;
+		float NextToggle = 0;
+		float NextStrafeChange = 0;
+		float StrafeDirection = 1;
+	};
+
+	void SpawnBots();
+
+	//Runs the scripted behaviour of all bots
+	void UpdateBots();
+
+	void Report();
+
+	TArray<FBot> Bots;
+
+	//Fixed seed, so runs with the same options do the same
+	FRandomStream Random;
+
+	//Time since StartPlay, unaffected by time dilation
+	float ElapsedTime = 0;
+
+	bool bReported = false;
+
+	//Game thread time of every measured frame, without the time the server idled to keep its tick rate
+	TArray<float> FrameTimes;
+
+	//Frames of the counter phase with stats, the counters are averaged over these
+	int32 CounterFrames = 0;
+
+	//Sums over the counter frames, see FTargetLockFrameStats
+	int64 LineOfSightTraces = 0;
+	int64 SkippedTraces = 0;
+	double AcquisitionMicroseconds = 0;
+	double SolveMicroseconds = 0;
+
+	//Sum of the bots with an active lock ability over the measured frames
+	int64 LockingBotSamples = 0;
+};